@@ -0,0 +1,172 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "Affinity.h"
+#include "Topology.h"
+
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <tuple>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+bool parseBindPolicy(const std::string& spec, BindPolicy& policy, std::vector<int>& list)
+{
+  list.clear();
+  if (spec == "none")
+    policy = BindPolicy::None;
+  else if (spec == "compact")
+    policy = BindPolicy::Compact;
+  else if (spec == "scatter")
+    policy = BindPolicy::Scatter;
+  else if (spec == "numa")
+    policy = BindPolicy::Numa;
+  else if (spec.compare(0, 5, "list:") == 0)
+  {
+    policy = BindPolicy::List;
+    list = parseCpuList(spec.substr(5));
+    return !list.empty();
+  }
+  else
+    return false;
+  return true;
+}
+
+// Places grouped by one of their fields, in order of the field
+template <class F>
+static std::vector<std::vector<CpuPlace>> groupBy(const std::vector<CpuPlace>& places, F field)
+{
+  std::map<int, std::vector<CpuPlace>> groups;
+  for (const CpuPlace& place : places)
+    groups[field(place)].push_back(place);
+  std::vector<std::vector<CpuPlace>> grouped;
+  for (auto& group : groups)
+    grouped.push_back(group.second);
+  return grouped;
+}
+
+// The first place of each group, then the second of each, and so on
+static std::vector<CpuPlace> interleave(const std::vector<std::vector<CpuPlace>>& groups)
+{
+  std::vector<CpuPlace> places;
+  for (size_t i = 0; ; i++)
+  {
+    const size_t before = places.size();
+    for (const std::vector<CpuPlace>& group : groups)
+      if (i < group.size())
+        places.push_back(group[i]);
+    if (places.size() == before)
+      return places;
+  }
+}
+
+std::vector<int> bindingCpus(BindPolicy policy, const std::vector<int>& list, bool smt, int threads)
+{
+  const std::vector<int> allowed = allowedCpus();
+  std::vector<int> order;
+
+  if (policy == BindPolicy::None)
+    return order;
+  if (policy == BindPolicy::List)
+  {
+    for (int cpu : list)
+      if (std::find(allowed.begin(), allowed.end(), cpu) == allowed.end())
+        return order;
+    order = list;
+  }
+  else
+  {
+    std::vector<CpuPlace> places;
+    for (const CpuPlace& place : cpuPlaces())
+      if ((smt || place.thread == 0) && std::find(allowed.begin(), allowed.end(), place.cpu) != allowed.end())
+        places.push_back(place);
+    // Without sysfs, every CPU is a core of its own on one node
+    if (places.empty())
+      for (int cpu : allowed)
+        places.push_back(CpuPlace{cpu, cpu, 0, 0, 0});
+
+    // Compact order: hardware threads of a core together, then cores of an L3 domain
+    std::sort(places.begin(), places.end(), [](const CpuPlace& x, const CpuPlace& y) {
+      return std::tie(x.node, x.l3, x.core, x.thread) < std::tie(y.node, y.l3, y.core, y.thread);
+    });
+
+    if (policy == BindPolicy::Numa)
+    {
+      // Consecutive threads share a node, so that they work on neighbouring parts of
+      // the arrays, as with first touch under a static schedule
+      const std::vector<std::vector<CpuPlace>> nodes = groupBy(places, [](const CpuPlace& p) { return p.node; });
+      if (threads <= 0)
+        threads = (int)places.size();
+      for (int node = 0, first = 0; node < (int)nodes.size(); node++)
+      {
+        const int last = (int)((long)threads * (node + 1) / nodes.size());
+        for (int thread = first; thread < last; thread++)
+          order.push_back(nodes[node][(thread - first) % nodes[node].size()].cpu);
+        first = last;
+      }
+      return order;
+    }
+
+    if (policy == BindPolicy::Scatter)
+    {
+      // One hardware thread of every core first, spread over nodes and their L3 domains
+      std::vector<CpuPlace> spread;
+      for (const std::vector<CpuPlace>& level : groupBy(places, [](const CpuPlace& p) { return p.thread; }))
+      {
+        std::vector<std::vector<CpuPlace>> nodes;
+        for (const std::vector<CpuPlace>& node : groupBy(level, [](const CpuPlace& p) { return p.node; }))
+          nodes.push_back(interleave(groupBy(node, [](const CpuPlace& p) { return p.l3; })));
+        const std::vector<CpuPlace> next = interleave(nodes);
+        spread.insert(spread.end(), next.begin(), next.end());
+      }
+      places = spread;
+    }
+
+    for (const CpuPlace& place : places)
+      order.push_back(place.cpu);
+  }
+
+  if (threads <= 0)
+    return order;
+  std::vector<int> cpus;
+  for (int thread = 0; thread < threads; thread++)
+    cpus.push_back(order[thread % order.size()]);
+  return cpus;
+}
+
+std::vector<int> allowedCpus()
+{
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+      if (CPU_ISSET(cpu, &set))
+        cpus.push_back(cpu);
+#endif
+  if (cpus.empty())
+    for (unsigned int cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++)
+      cpus.push_back(cpu);
+  return cpus;
+}
+
+bool pinThread(int cpu)
+{
+#ifdef __linux__
+  if (cpu < 0 || cpu >= CPU_SETSIZE)
+    return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Placement of the threads of a model on the CPUs of the host, see --bind.
+// A binding is a list of CPUs in thread order: thread i of the model is pinned to
+// cpus[i % cpus.size()].
+
+enum class BindPolicy
+{
+  None,      // Leave placement to the OS and the parallel runtime
+  Compact,   // Fill one L3 domain, then one NUMA node, before moving to the next
+  Scatter,   // Round-robin over the NUMA nodes, and over the L3 domains of each
+  Numa,      // Split the threads evenly between the NUMA nodes, in consecutive blocks
+  List       // CPUs given explicitly, in thread order
+};
+
+// Parse "none", "compact", "scatter", "numa" or "list:CPUS" (e.g. "list:0-3,8") into a
+// policy and, for list, its CPUs. Returns false on malformed input.
+bool parseBindPolicy(const std::string& spec, BindPolicy& policy, std::vector<int>& list);
+
+// Binding of `threads` threads under a policy, among the CPUs the process may run on;
+// with threads <= 0, one thread per CPU the policy can use. Unless smt is set, only the
+// first hardware thread of each core is used (a list is taken as given). Empty for None,
+// or if a listed CPU may not be used.
+std::vector<int> bindingCpus(BindPolicy policy, const std::vector<int>& list, bool smt, int threads);
+
+// CPUs the calling thread may run on, or 0..hardware_concurrency-1 where unknown
+std::vector<int> allowedCpus();
+
+// Pin the calling thread to one CPU, returns false if it could not be
+bool pinThread(int cpu);
+
+#ifdef _OPENMP
+#include <omp.h>
+
+// Pin thread i of the OpenMP team to cpus[i % cpus.size()]. Places and proc_bind are
+// fixed when the runtime starts, so the threads pin themselves instead. Runtimes keep
+// the thread behind each number across parallel regions of the same size; call this
+// again after changing the number of threads.
+inline bool pinOpenMPThreads(const std::vector<int>& cpus)
+{
+  int failed = 0;
+  #pragma omp parallel reduction(+:failed)
+  failed += !pinThread(cpus[omp_get_thread_num() % cpus.size()]);
+  return failed == 0;
+}
+#endif
@@ -0,0 +1,102 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "IndexPatterns.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+// Default block and window sizes in elements: a block is a few pages of doubles, and a
+// window fits comfortably in L1 cache
+static const intptr_t default_block = 1024;
+static const intptr_t default_window = 256;
+
+std::string IndexPattern::name() const
+{
+  switch (kind)
+  {
+    case Identity: return "identity";
+    case Block:    return "block:" + std::to_string(size);
+    case Random:   return "random";
+    case Window:   return "window:" + std::to_string(size);
+  }
+  return "";
+}
+
+std::vector<IndexPattern> parseIndexPatterns(const std::string& list)
+{
+  if (list == "all")
+    return {
+      {IndexPattern::Identity, 1},
+      {IndexPattern::Window, default_window},
+      {IndexPattern::Block, default_block},
+      {IndexPattern::Random, 1}};
+
+  std::vector<IndexPattern> patterns;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+  {
+    const size_t colon = item.find(':');
+    const std::string name = item.substr(0, colon);
+    intptr_t size = 0;
+    if (colon != std::string::npos)
+    {
+      char *next;
+      size = std::strtoll(item.c_str() + colon + 1, &next, 10);
+      if (*next != '\0' || size < 1)
+        return {};
+    }
+
+    if (name == "identity" && colon == std::string::npos)
+      patterns.push_back({IndexPattern::Identity, 1});
+    else if (name == "random" && colon == std::string::npos)
+      patterns.push_back({IndexPattern::Random, 1});
+    else if (name == "block")
+      patterns.push_back({IndexPattern::Block, size > 0 ? size : default_block});
+    else if (name == "window")
+      patterns.push_back({IndexPattern::Window, size > 0 ? size : default_window});
+    else
+      return {};
+  }
+  return patterns;
+}
+
+std::vector<intptr_t> makeIndices(const IndexPattern& pattern, intptr_t n)
+{
+  std::vector<intptr_t> indices(n);
+  std::iota(indices.begin(), indices.end(), intptr_t{0});
+  std::mt19937_64 rng(n);
+
+  switch (pattern.kind)
+  {
+    case IndexPattern::Identity:
+      break;
+    case IndexPattern::Random:
+      std::shuffle(indices.begin(), indices.end(), rng);
+      break;
+    case IndexPattern::Window:
+      for (intptr_t start = 0; start < n; start += pattern.size)
+        std::shuffle(indices.begin() + start, indices.begin() + std::min(start + pattern.size, n), rng);
+      break;
+    case IndexPattern::Block:
+    {
+      // Shuffle the order of the blocks, keeping each block's indices in order
+      std::vector<intptr_t> blocks((n + pattern.size - 1) / pattern.size);
+      std::iota(blocks.begin(), blocks.end(), intptr_t{0});
+      std::shuffle(blocks.begin(), blocks.end(), rng);
+      intptr_t i = 0;
+      for (intptr_t block : blocks)
+        for (intptr_t j = block * pattern.size; j < std::min((block + 1) * pattern.size, n); j++)
+          indices[i++] = j;
+      break;
+    }
+  }
+  return indices;
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Index arrays for the gather and scatter kernels. Every pattern is a permutation of
+// 0 .. n-1, so that scatter writes each element exactly once.
+struct IndexPattern
+{
+  enum Kind
+  {
+    Identity,   // idx[i] = i
+    Block,      // Blocks of `size` consecutive indices, in random order
+    Random,     // Random permutation of all indices
+    Window      // Random permutation within each window of `size` elements
+  };
+
+  Kind kind;
+  intptr_t size;
+
+  // Name as accepted by parseIndexPatterns, e.g. "block:1024"
+  std::string name() const;
+};
+
+// Parse comma-separated patterns such as identity,block:1024,random,window:64, or "all".
+// Block and window sizes are optional. Returns an empty list on malformed input.
+std::vector<IndexPattern> parseIndexPatterns(const std::string& list);
+
+// Indices of a pattern for n elements; the same pattern and n always give the same indices
+std::vector<intptr_t> makeIndices(const IndexPattern& pattern, intptr_t n);
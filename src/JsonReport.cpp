@@ -0,0 +1,129 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "JsonReport.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+std::string jsonString(const std::string& str)
+{
+  std::string out = "\"";
+  for (char c : str)
+  {
+    switch (c)
+    {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        }
+        else
+          out += c;
+    }
+  }
+  return out + "\"";
+}
+
+// Format a number losslessly; JSON has no representation for inf or nan
+static std::string jsonNumber(double value)
+{
+  if (!std::isfinite(value))
+    return "null";
+  std::ostringstream ss;
+  ss.precision(std::numeric_limits<double>::max_digits10);
+  ss << value;
+  return ss.str();
+}
+
+JsonReport::JsonReport(const std::string& path, bool ndjson, const RunMetadata& meta)
+  : file(path, ndjson ? std::ios::app : std::ios::trunc), ndjson(ndjson)
+{
+  if (!file)
+    std::cerr << "Warning: cannot open " << path << " for writing" << std::endl;
+
+  std::ostringstream ss;
+  ss << "{"
+     << "\"hostname\":" << jsonString(meta.hostname) << ","
+     << "\"implementation\":" << jsonString(meta.implementation) << ","
+     << "\"compiler\":" << jsonString(meta.compiler) << ","
+     << "\"flags\":" << jsonString(meta.flags) << ","
+     << "\"threads\":" << meta.threads << ","
+     << "\"binding\":[";
+  for (size_t thread = 0; thread < meta.binding.size(); thread++)
+    ss << (thread == 0 ? "" : ",") << meta.binding[thread];
+  ss << "],"
+     << "\"precision\":" << jsonString(meta.precision)
+     << "}";
+  metadata = ss.str();
+}
+
+JsonReport::~JsonReport()
+{
+  if (ndjson)
+    return;
+
+  file << "{\"metadata\":" << metadata << ",\"results\":[";
+  for (size_t i = 0; i < results.size(); i++)
+    file << (i ? ",\n" : "\n") << results[i];
+  file << "\n]}" << std::endl;
+}
+
+void JsonReport::add(const std::string& function, intptr_t n_elements, size_t type_size, size_t bytes,
+                     const std::vector<double>& samples, unsigned int warmups, const Statistics& stats,
+                     double scale, const std::string& unit)
+{
+  std::ostringstream ss;
+  ss << "{";
+  if (ndjson)
+    ss << "\"metadata\":" << metadata << ",";
+  ss << "\"function\":" << jsonString(function) << ","
+     << "\"n_elements\":" << n_elements << ","
+     << "\"sizeof\":" << type_size << ","
+     << "\"bytes\":" << bytes << ","
+     << "\"warmups\":" << warmups << ","
+     << "\"samples\":[";
+  for (size_t i = 0; i < samples.size(); i++)
+    ss << (i ? "," : "") << jsonNumber(samples[i]);
+  ss << "],"
+     << "\"runtime\":{"
+     << "\"count\":" << stats.count << ","
+     << "\"min\":" << jsonNumber(stats.min) << ","
+     << "\"min_corrected\":" << jsonNumber(stats.min_corrected) << ","
+     << "\"max\":" << jsonNumber(stats.max) << ","
+     << "\"mean\":" << jsonNumber(stats.mean) << ","
+     << "\"median\":" << jsonNumber(stats.median) << ","
+     << "\"p5\":" << jsonNumber(stats.p5) << ","
+     << "\"p95\":" << jsonNumber(stats.p95) << ","
+     << "\"p99\":" << jsonNumber(stats.p99) << ","
+     << "\"stddev\":" << jsonNumber(stats.stddev) << ","
+     << "\"cv\":" << jsonNumber(stats.cv) << ","
+     << "\"ci95\":[" << jsonNumber(stats.ci95_low) << "," << jsonNumber(stats.ci95_high) << "]"
+     << "},"
+     << "\"bandwidth\":{"
+     << "\"unit\":" << jsonString(unit) << ","
+     << "\"max\":" << jsonNumber(scale * bytes / stats.min) << ","
+     << "\"max_corrected\":" << jsonNumber(scale * bytes / stats.min_corrected) << ","
+     << "\"mean\":" << jsonNumber(scale * bytes / stats.mean) << ","
+     << "\"ci95\":[" << jsonNumber(scale * bytes / stats.ci95_high) << ","
+     << (stats.ci95_low > 0.0 ? jsonNumber(scale * bytes / stats.ci95_low) : "null") << "]"
+     << "}"
+     << "}";
+
+  if (ndjson)
+    file << ss.str() << std::endl;
+  else
+    results.push_back(ss.str());
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Statistics.h"
+
+// Describes the build and host a set of results was measured on
+struct RunMetadata
+{
+  std::string hostname;
+  std::string implementation;
+  std::string compiler;
+  std::string flags;
+  std::string precision;
+  int threads;
+  std::vector<int> binding;   // CPU of each thread, empty if not bound
+};
+
+// Writes per-kernel results, including every timed sample, as JSON.
+// In JSON mode a single document holding the metadata and an array of results is
+// written when the report is destroyed. In NDJSON mode one self-contained line,
+// repeating the metadata, is appended per result so that runs can be concatenated.
+class JsonReport
+{
+  public:
+    JsonReport(const std::string& path, bool ndjson, const RunMetadata& metadata);
+    ~JsonReport();
+
+    // Record one kernel at one array size; samples are runtimes in seconds, of which
+    // the first `warmups` were excluded from stats. Bandwidths are reported in the
+    // given unit, scaled from bytes per second by `scale`.
+    void add(const std::string& function, intptr_t n_elements, size_t type_size, size_t bytes,
+             const std::vector<double>& samples, unsigned int warmups, const Statistics& stats,
+             double scale, const std::string& unit);
+
+  private:
+    std::ofstream file;
+    bool ndjson;
+    std::string metadata;
+    std::vector<std::string> results;
+};
+
+// Quote and escape a string as a JSON string literal
+std::string jsonString(const std::string& str);
@@ -0,0 +1,117 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Stream.h"
+#include "StreamTypes.h"
+
+// Kernels reading R arrays and writing W arrays, for Stream<T>::mix.
+// With arrays[0..W) as outputs and arrays[W..W+R) as inputs, each element does
+//   s = in_0[i] + ... + in_R-1[i];  out_j[i] = s / R (or initB if R == 0)
+// and the kernel returns the sum of s over all elements. s and the sum are kept in
+// Element<T>::MixSum, so that the sum rounds to T once, at the end. Every array starts out filled
+// with Element<T>::initB(), so the outputs keep that value and any array can later serve as input:
+// running mix(W, 0) after mix(R, W) sums the outputs, which validates them.
+
+#define MIX_MAX_READS 8
+#define MIX_MAX_WRITES 4
+
+inline bool mix_supported(unsigned int reads, unsigned int writes)
+{
+  return reads <= MIX_MAX_READS && writes <= MIX_MAX_WRITES && reads + writes > 0;
+}
+
+template <unsigned int R, unsigned int W>
+struct MixKernel
+{
+  // Write element i of the outputs, returns the sum of the inputs at i
+  template <typename T>
+  static inline typename Element<T>::MixSum apply(T *const *arrays, intptr_t i)
+  {
+    typedef typename Element<T>::MixSum MixSum;
+    MixSum sum{};
+    for (unsigned int r = 0; r < R; r++)
+      sum += MixSum(arrays[W + r][i]);
+    // Integers divide, as the reciprocal of R truncates to 0
+    const MixSum divisor = MixSum(R == 0 ? 1 : R);
+    const T value = R == 0 ? Element<T>::initB()
+                  : std::is_integral<T>::value ? T(sum / divisor) : T(sum * (MixSum(1) / divisor));
+    for (unsigned int w = 0; w < W; w++)
+      arrays[w][i] = value;
+    return sum;
+  }
+};
+
+// Call stream.mix_kernel<R, W>(arrays) for the R and W given at runtime, trying every
+// combination up to MIX_MAX_READS:MIX_MAX_WRITES
+template <unsigned int R, unsigned int W>
+struct MixDispatch
+{
+  template <class S, typename T>
+  static typename Element<T>::MixSum call(S& stream, T *const *arrays, unsigned int reads, unsigned int writes)
+  {
+    if (reads == R && writes == W)
+      return stream.template mix_kernel<R, W>(arrays);
+    return MixDispatch<W == MIX_MAX_WRITES ? R + 1 : R, W == MIX_MAX_WRITES ? 0 : W + 1>::call(stream, arrays, reads, writes);
+  }
+};
+
+template <>
+struct MixDispatch<MIX_MAX_READS + 1, 0>
+{
+  template <class S, typename T>
+  static typename Element<T>::MixSum call(S&, T *const *, unsigned int, unsigned int)
+  {
+    return typename Element<T>::MixSum{};
+  }
+};
+
+// Arrays of a model used by the mix kernels, allocated on first use with the model's
+// allocator so that they live wherever the model's own arrays do
+template <typename T>
+class MixArrays
+{
+  public:
+    // alloc and dealloc take and free arrays of a number of elements
+    MixArrays(T *(*alloc)(size_t), void (*dealloc)(T *)) : alloc(alloc), dealloc(dealloc), size(0) {}
+    ~MixArrays() { clear(); }
+
+    // Make sure there are at least n arrays of `elements` each. Returns how many of the
+    // first n were already there; the rest are new and must be filled with initB.
+    size_t resize(size_t n, intptr_t elements)
+    {
+      if (elements > size)
+      {
+        clear();
+        size = elements;
+      }
+      const size_t kept = std::min(arrays.size(), n);
+      while (arrays.size() < n)
+        arrays.push_back(alloc(size));
+      return kept;
+    }
+
+    T *const *data() const { return arrays.data(); }
+
+  private:
+    void clear()
+    {
+      for (T *array : arrays)
+        dealloc(array);
+      arrays.clear();
+    }
+
+    T *(*alloc)(size_t);
+    void (*dealloc)(T *);
+    intptr_t size;
+    std::vector<T *> arrays;
+};
@@ -0,0 +1,388 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "PageAllocator.h"
+#include "Topology.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#endif
+
+#ifndef ALIGNMENT
+#define ALIGNMENT (2*1024*1024) // 2MB
+#endif
+
+static const size_t huge_2m = 2UL * 1024 * 1024;
+static const size_t huge_1g = 1024UL * 1024 * 1024;
+
+struct Allocation
+{
+  size_t bytes;     // Requested
+  size_t mapped;    // Length of the mapping, 0 if from aligned_alloc
+  PageMode mode;
+  NumaPolicy policy;
+  int node;
+};
+
+static PageMode current_mode = PageMode::Default;
+static NumaPolicy current_policy = NumaPolicy::Local;
+static int current_node = 0;
+static std::mutex allocations_lock;
+static std::map<uintptr_t, Allocation> allocations;
+// Freed allocations kept for reuse, see setPageReuse
+static bool reuse = false;
+static std::vector<std::pair<void *, Allocation>> spares;
+
+bool parsePageMode(const std::string& name, PageMode& mode)
+{
+  if (name == "default")
+    mode = PageMode::Default;
+  else if (name == "none")
+    mode = PageMode::None;
+  else if (name == "thp")
+    mode = PageMode::THP;
+  else if (name == "hugetlb-2m")
+    mode = PageMode::Hugetlb2M;
+  else if (name == "hugetlb-1g")
+    mode = PageMode::Hugetlb1G;
+  else if (name == "sparse")
+    mode = PageMode::Sparse;
+  else
+    return false;
+  return true;
+}
+
+void setPageMode(PageMode mode)
+{
+  current_mode = mode;
+}
+
+bool parseNumaPolicy(const std::string& spec, NumaPolicy& policy, int& node)
+{
+  if (spec == "local")
+    policy = NumaPolicy::Local;
+  else if (spec == "interleave")
+    policy = NumaPolicy::Interleave;
+  else if (spec == "replicate")
+    policy = NumaPolicy::Replicate;
+  else if (spec.compare(0, 5, "bind:") == 0 && spec.size() > 5)
+  {
+    char *end;
+    const long value = std::strtol(spec.c_str() + 5, &end, 10);
+    if (*end != '\0' || value < 0 || value > INT_MAX)
+      return false;
+    policy = NumaPolicy::Bind;
+    node = static_cast<int>(value);
+  }
+  else
+    return false;
+  return true;
+}
+
+void setNumaPolicy(NumaPolicy policy, int node)
+{
+  current_policy = policy;
+  current_node = node;
+}
+
+NumaPolicy numaPolicy()
+{
+  return current_policy;
+}
+
+static size_t roundUp(size_t bytes, size_t page)
+{
+  return (bytes + page - 1) / page * page;
+}
+
+[[noreturn]] static void allocationError(const std::string& what, size_t bytes, int error)
+{
+  std::cerr << "Error: cannot allocate " << bytes << " bytes " << what << ": " << std::strerror(error);
+  if (error == ENOMEM && what.find("hugetlb") != std::string::npos)
+    std::cerr << ", see /sys/kernel/mm/hugepages/*/nr_hugepages";
+  std::cerr << std::endl;
+  exit(EXIT_FAILURE);
+}
+
+#ifdef __linux__
+// Anonymous mapping of whole huge_2m pages starting on a multiple of huge_2m, so that
+// THP can back all of it, with extra mmap flags
+static void *mapAligned(size_t length, int flags)
+{
+  void *base = mmap(nullptr, length + huge_2m, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+  if (base == MAP_FAILED)
+    return nullptr;
+  const uintptr_t start = reinterpret_cast<uintptr_t>(base);
+  const uintptr_t aligned = roundUp(start, huge_2m);
+  if (aligned > start)
+    munmap(base, aligned - start);
+  if (start + huge_2m > aligned)
+    munmap(reinterpret_cast<void *>(aligned + length), start + huge_2m - aligned);
+  return reinterpret_cast<void *>(aligned);
+}
+#endif
+
+#ifdef __linux__
+// Set the policy of the pages of an allocation before they are touched; pages that
+// already exist, e.g. reused by aligned_alloc, are moved
+static void applyPolicy(void *p, size_t bytes, NumaPolicy policy, int node)
+{
+  if (policy != NumaPolicy::Interleave && policy != NumaPolicy::Bind)
+    return;
+
+  std::vector<int> nodes = policy == NumaPolicy::Bind ? std::vector<int>(1, node) : numaMemoryNodes();
+  if (nodes.empty())
+    nodes.push_back(0);
+  const size_t bits = 8 * sizeof(unsigned long);
+  std::vector<unsigned long> mask(*std::max_element(nodes.begin(), nodes.end()) / bits + 1, 0);
+  for (int n : nodes)
+    mask[n / bits] |= 1UL << (n % bits);
+
+  const size_t page = sysconf(_SC_PAGESIZE);
+  if (syscall(SYS_mbind, p, roundUp(bytes, page), policy == NumaPolicy::Bind ? MPOL_BIND : MPOL_INTERLEAVE,
+              mask.data(), mask.size() * bits + 1, MPOL_MF_MOVE) != 0)
+  {
+    std::cerr << "Error: cannot " << (policy == NumaPolicy::Bind ? "bind " : "interleave ") << bytes
+      << " bytes " << (policy == NumaPolicy::Bind ? "to NUMA node " : "over NUMA nodes ")
+      << formatCpuList(nodes) << ": " << std::strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+#endif
+
+// Unmap or free the memory of an allocation
+static void release(void *p, const Allocation& allocation)
+{
+#ifdef __linux__
+  if (allocation.mapped > 0)
+  {
+    munmap(p, allocation.mapped);
+    return;
+  }
+#endif
+  free(p);
+}
+
+// Take a kept allocation matching the request, or release all those kept
+static void *reuseSpare(size_t bytes, NumaPolicy policy, int node)
+{
+  std::lock_guard<std::mutex> guard(allocations_lock);
+  for (size_t i = 0; i < spares.size(); i++)
+  {
+    const Allocation& spare = spares[i].second;
+    if (spare.bytes == bytes && spare.mode == current_mode && spare.policy == policy
+        && (policy != NumaPolicy::Bind || spare.node == node))
+    {
+      void *p = spares[i].first;
+      allocations[reinterpret_cast<uintptr_t>(p)] = spare;
+      spares.erase(spares.begin() + i);
+      return p;
+    }
+  }
+  for (const std::pair<void *, Allocation>& spare : spares)
+    release(spare.first, spare.second);
+  spares.clear();
+  return nullptr;
+}
+
+static void *allocate(size_t bytes, NumaPolicy policy, int node)
+{
+  // Zero-length mappings are invalid
+  bytes = bytes > 0 ? bytes : 1;
+  Allocation allocation{bytes, 0, current_mode, policy, node};
+  void *p = reuseSpare(bytes, policy, node);
+  if (p)
+    return p;
+
+  switch (current_mode)
+  {
+    case PageMode::Default:
+      p = aligned_alloc(ALIGNMENT, bytes);
+      if (!p)
+        allocationError("", bytes, ENOMEM);
+      break;
+#ifdef __linux__
+    case PageMode::None:
+    case PageMode::THP:
+    case PageMode::Sparse:
+      allocation.mapped = roundUp(bytes, huge_2m);
+      // Without a reservation the mapping may exceed memory plus swap
+      p = mapAligned(allocation.mapped, current_mode == PageMode::Sparse ? MAP_NORESERVE : 0);
+      if (!p)
+        allocationError(current_mode == PageMode::THP ? "for THP" : "", bytes, errno);
+      // Ask before first touch, the fault handler decides the page size
+      if (madvise(p, allocation.mapped, current_mode == PageMode::THP ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) != 0)
+        allocationError(current_mode == PageMode::THP ? "with MADV_HUGEPAGE" : "with MADV_NOHUGEPAGE", bytes, errno);
+      break;
+    case PageMode::Hugetlb2M:
+    case PageMode::Hugetlb1G:
+    {
+      const bool gigantic = current_mode == PageMode::Hugetlb1G;
+      allocation.mapped = roundUp(bytes, gigantic ? huge_1g : huge_2m);
+      p = mmap(nullptr, allocation.mapped, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (gigantic ? MAP_HUGE_1GB : MAP_HUGE_2MB), -1, 0);
+      if (p == MAP_FAILED)
+        allocationError(gigantic ? "from the 1 GB hugetlb pool" : "from the 2 MB hugetlb pool", bytes, errno);
+      break;
+    }
+#else
+    default:
+      std::cerr << "Error: only the default page mode is supported on this platform" << std::endl;
+      exit(EXIT_FAILURE);
+#endif
+  }
+
+#ifdef __linux__
+  applyPolicy(p, bytes, policy, node);
+#endif
+
+  std::lock_guard<std::mutex> guard(allocations_lock);
+  allocations[reinterpret_cast<uintptr_t>(p)] = allocation;
+  return p;
+}
+
+void *allocPages(size_t bytes)
+{
+  return allocate(bytes, current_policy, current_node);
+}
+
+void *allocPagesOnNode(size_t bytes, int node)
+{
+  return allocate(bytes, NumaPolicy::Bind, node);
+}
+
+void freePages(void *p)
+{
+  if (!p)
+    return;
+  Allocation allocation{0, 0, PageMode::Default, NumaPolicy::Local, 0};
+  {
+    std::lock_guard<std::mutex> guard(allocations_lock);
+    std::map<uintptr_t, Allocation>::iterator it = allocations.find(reinterpret_cast<uintptr_t>(p));
+    if (it != allocations.end())
+    {
+      allocation = it->second;
+      allocations.erase(it);
+      if (reuse)
+      {
+        spares.push_back(std::make_pair(p, allocation));
+        return;
+      }
+    }
+  }
+  release(p, allocation);
+}
+
+void setPageReuse(bool enabled)
+{
+  std::lock_guard<std::mutex> guard(allocations_lock);
+  reuse = enabled;
+  if (!enabled)
+  {
+    for (const std::pair<void *, Allocation>& spare : spares)
+      release(spare.first, spare.second);
+    spares.clear();
+  }
+}
+
+PageUsage pageUsage()
+{
+  PageUsage usage{0, 0, 0, {}};
+#ifdef __linux__
+  std::lock_guard<std::mutex> guard(allocations_lock);
+
+  // Node of a sample of up to max_samples pages of each allocation, each standing for
+  // the pages up to the next sample
+  const size_t page = sysconf(_SC_PAGESIZE);
+  const size_t max_samples = 4096;
+  std::map<int, size_t> nodes;
+  for (const std::pair<const uintptr_t, Allocation>& allocation : allocations)
+  {
+    const size_t step = roundUp(std::max(page, allocation.second.bytes / max_samples), page);
+    std::vector<void *> pages;
+    for (size_t offset = 0; offset < allocation.second.bytes; offset += step)
+      pages.push_back(reinterpret_cast<void *>((allocation.first + offset) / page * page));
+    // Pages not touched yet have a negative status
+    std::vector<int> status(pages.size(), -1);
+    if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0)
+      continue;
+    for (size_t i = 0; i < pages.size(); i++)
+      if (status[i] >= 0)
+        nodes[status[i]] += std::min(step, allocation.second.bytes - i * step);
+  }
+  usage.nodes.assign(nodes.begin(), nodes.end());
+
+  std::ifstream smaps("/proc/self/smaps");
+  std::string line;
+  double share = 0.0;
+  while (std::getline(smaps, line))
+  {
+    // A mapping starts with "start-end perms ...", its fields follow as "Name: value kB"
+    std::stringstream ss(line);
+    std::string first, value;
+    ss >> first >> value;
+    if (first.empty() || first.back() != ':')
+    {
+      const size_t dash = first.find('-');
+      if (dash == std::string::npos)
+        continue;
+      const uintptr_t start = std::strtoull(first.c_str(), nullptr, 16);
+      const uintptr_t end = std::strtoull(first.c_str() + dash + 1, nullptr, 16);
+      // Share of the mapping that is allocations, as the kernel merges neighbouring
+      // mappings with the same flags, e.g. the driver's own arrays
+      uintptr_t overlap = 0;
+      for (const std::pair<const uintptr_t, Allocation>& allocation : allocations)
+      {
+        const uintptr_t first_byte = std::max(start, allocation.first);
+        const uintptr_t last_byte = std::min(end, allocation.first + allocation.second.bytes);
+        overlap += last_byte > first_byte ? last_byte - first_byte : 0;
+      }
+      share = end > start ? double(overlap) / (end - start) : 0.0;
+      continue;
+    }
+    if (share == 0.0)
+      continue;
+    const size_t bytes = std::strtoull(value.c_str(), nullptr, 10) * 1024 * share;
+    if (first == "Rss:")
+      usage.resident += bytes;
+    else if (first == "AnonHugePages:")
+      usage.thp += bytes;
+    else if (first == "Private_Hugetlb:" || first == "Shared_Hugetlb:")
+    {
+      // hugetlbfs pages are not part of Rss
+      usage.hugetlb += bytes;
+      usage.resident += bytes;
+    }
+  }
+#endif
+  return usage;
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Host allocator shared by the CPU models, with the kind of pages behind the arrays
+// chosen at runtime:
+//   default     aligned_alloc, leaving huge pages to the kernel's THP policy
+//   none        mmap with MADV_NOHUGEPAGE, base pages only
+//   thp         mmap aligned to 2 MB with MADV_HUGEPAGE
+//   hugetlb-2m  mmap with MAP_HUGETLB from the 2 MB pool (/proc/sys/vm/nr_hugepages)
+//   hugetlb-1g  mmap with MAP_HUGETLB from the 1 GB pool
+//   sparse      as none, but with MAP_NORESERVE, so that arrays larger than memory can
+//               be mapped as long as only a few of their pages are touched
+// Every mode but default needs Linux.
+enum class PageMode { Default, None, THP, Hugetlb2M, Hugetlb1G, Sparse };
+
+// Parse one of the names above, returns false if unknown
+bool parsePageMode(const std::string& name, PageMode& mode);
+
+// Mode used by allocPages from now on
+void setPageMode(PageMode mode);
+
+// Placement of the pages of each allocation across NUMA nodes (Linux):
+//   local       first touch, on the node of the thread that writes a page first
+//   interleave  page by page over all nodes with memory
+//   bind:N      on node N
+//   replicate   first touch; models that support Stream<T>::set_replicated then give
+//               the threads of each node their own arrays with allocPagesOnNode
+enum class NumaPolicy { Local, Interleave, Bind, Replicate };
+
+// Parse one of the names above, with the node of bind:N, returns false if unknown
+bool parseNumaPolicy(const std::string& spec, NumaPolicy& policy, int& node);
+
+// Policy used by allocPages from now on, node is for NumaPolicy::Bind
+void setNumaPolicy(NumaPolicy policy, int node);
+NumaPolicy numaPolicy();
+
+// Allocate bytes aligned to at least 2 MB with the current mode; exits with an error
+// message if the pages cannot be had, e.g. an empty hugetlb pool
+void *allocPages(size_t bytes);
+
+// As allocPages, but with every page bound to one NUMA node
+void *allocPagesOnNode(size_t bytes, int node);
+
+// Free memory from allocPages, in whatever mode it was allocated
+void freePages(void *p);
+
+// Whether freePages keeps memory for the next allocation of the same size, page mode
+// and NUMA placement, which then gets back pages already placed by first touch, e.g.
+// for the arrays of the next element type of --type all. An allocation that matches
+// none of the memory kept releases it all; turning reuse off does too.
+void setPageReuse(bool enabled);
+
+template <typename T>
+T *allocArray(size_t n)
+{
+  return static_cast<T *>(allocPages(sizeof(T) * n));
+}
+
+// Allocator for std::vector through allocPages. Elements are default-initialised, so a
+// vector of numbers is not zero-filled and its pages are placed by whoever writes first.
+template <typename T>
+struct PageVectorAllocator
+{
+  typedef T value_type;
+
+  PageVectorAllocator() {}
+  template <typename U>
+  PageVectorAllocator(const PageVectorAllocator<U>&) {}
+
+  T *allocate(size_t n) { return allocArray<T>(n); }
+  void deallocate(T *p, size_t) { freePages(p); }
+
+  template <typename U>
+  void construct(U *p) { ::new (static_cast<void *>(p)) U; }
+  template <typename U, typename... Args>
+  void construct(U *p, Args&&... args) { ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+
+  template <typename U>
+  bool operator==(const PageVectorAllocator<U>&) const { return true; }
+  template <typename U>
+  bool operator!=(const PageVectorAllocator<U>&) const { return false; }
+};
+
+// Resident memory of the live allocations, and how much of it is backed by huge pages,
+// from /proc/self/smaps. Where a mapping also holds other memory its counts are shared
+// out by size, so the figures are estimates. All zero where smaps is unavailable.
+struct PageUsage
+{
+  size_t resident;  // Bytes
+  size_t thp;       // Bytes in transparent huge pages
+  size_t hugetlb;   // Bytes in hugetlbfs pages
+  std::vector<std::pair<int, size_t>> nodes;  // Bytes on each NUMA node, sampled with move_pages
+};
+
+PageUsage pageUsage();
@@ -0,0 +1,211 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "PerfCounters.h"
+#include "Topology.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const std::string sysfs_pmu = "/sys/bus/event_source/devices";
+
+static std::string readLine(const std::string& path)
+{
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+static int perfEventOpen(perf_event_attr& attr, pid_t pid, int cpu)
+{
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, cpu, -1, 0));
+}
+
+static std::string openError(const std::string& name, int error)
+{
+  std::string reason = name + " (" + std::strerror(error);
+  if (error == EACCES || error == EPERM)
+    reason += ", see /proc/sys/kernel/perf_event_paranoid";
+  return reason + ")";
+}
+
+// Place `value` into the bits of `config` named by a PMU format such as "config:8-15"
+static bool applyFormat(const std::string& format, unsigned long long value, unsigned long long& config)
+{
+  if (format.compare(0, 7, "config:") != 0)
+    return false;
+  std::stringstream ss(format.substr(7));
+  std::string range;
+  while (std::getline(ss, range, ','))
+  {
+    char *next;
+    long first = std::strtol(range.c_str(), &next, 10);
+    long last = *next == '-' ? std::strtol(next + 1, &next, 10) : first;
+    for (long bit = first; bit <= last; bit++, value >>= 1)
+      config |= (value & 1ULL) << bit;
+  }
+  return true;
+}
+
+PerfCounters::PerfCounters(size_t kernels)
+  : totals(kernels), invocations(kernels, 0)
+{
+  const unsigned long long read_access = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16);
+  const unsigned long long read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+  open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 1.0);
+  open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 1.0);
+  open("LLC-loads", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | read_access, 1.0);
+  open("LLC-load-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | read_miss, 1.0);
+  open("dTLB-load-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | read_miss, 1.0);
+  open("page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, 1.0);
+  // Each CAS command reads a 64 byte line from DRAM
+  openUncore("DRAM-read-bytes", "cas_count_read", 64.0);
+
+  started.resize(counters.size());
+  for (std::vector<double>& total : totals)
+    total.assign(counters.size(), 0.0);
+}
+
+PerfCounters::~PerfCounters()
+{
+  for (const Counter& counter : counters)
+    for (int fd : counter.fds)
+      close(fd);
+}
+
+void PerfCounters::open(const std::string& name, unsigned int type, unsigned long long config, double scale)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  int fd = perfEventOpen(attr, 0, -1);
+  if (fd < 0)
+  {
+    failures += (failures.empty() ? "" : ", ") + openError(name, errno);
+    return;
+  }
+  names.push_back(name);
+  counters.push_back(Counter{{fd}, scale});
+}
+
+void PerfCounters::openUncore(const std::string& name, const std::string& event, double scale)
+{
+  Counter counter{{}, scale};
+  int error = ENOENT;
+
+  DIR *dir = opendir(sysfs_pmu.c_str());
+  while (struct dirent *entry = dir ? readdir(dir) : nullptr)
+  {
+    const std::string pmu = sysfs_pmu + "/" + entry->d_name;
+    const std::string spec = readLine(pmu + "/events/" + event);
+    if (std::string(entry->d_name).compare(0, 10, "uncore_imc") != 0 || spec.empty())
+      continue;
+
+    // Event specs look like "event=0x04,umask=0x03"
+    unsigned long long config = 0;
+    bool valid = true;
+    std::stringstream ss(spec);
+    std::string term;
+    while (valid && std::getline(ss, term, ','))
+    {
+      const size_t eq = term.find('=');
+      const unsigned long long value = eq == std::string::npos ? 1 : std::strtoull(term.c_str() + eq + 1, nullptr, 0);
+      valid = applyFormat(readLine(pmu + "/format/" + term.substr(0, eq)), value, config);
+    }
+    if (!valid)
+      continue;
+
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = std::atoi(readLine(pmu + "/type").c_str());
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // Uncore PMUs count for a whole socket, opened on one CPU of each
+    for (int cpu : parseCpuList(readLine(pmu + "/cpumask")))
+    {
+      int fd = perfEventOpen(attr, -1, cpu);
+      if (fd < 0)
+        error = errno;
+      else
+        counter.fds.push_back(fd);
+    }
+  }
+  if (dir)
+    closedir(dir);
+
+  if (counter.fds.empty())
+  {
+    failures += (failures.empty() ? "" : ", ") + openError(name, error);
+    return;
+  }
+  names.push_back(name);
+  counters.push_back(counter);
+}
+
+double PerfCounters::read(const Counter& counter) const
+{
+  double total = 0.0;
+  for (int fd : counter.fds)
+  {
+    uint64_t values[3];
+    if (::read(fd, values, sizeof(values)) != sizeof(values))
+      continue;
+    // Scale up counts of events that were multiplexed with others
+    total += values[2] > 0 ? (double)values[0] * values[1] / values[2] : (double)values[0];
+  }
+  return total * counter.scale;
+}
+
+void PerfCounters::start()
+{
+  for (size_t e = 0; e < counters.size(); e++)
+    started[e] = read(counters[e]);
+}
+
+void PerfCounters::stop(size_t kernel, unsigned int n)
+{
+  for (size_t e = 0; e < counters.size(); e++)
+    totals[kernel][e] += read(counters[e]) - started[e];
+  invocations[kernel] += n;
+}
+
+#else
+
+PerfCounters::PerfCounters(size_t kernels)
+  : failures("perf_event_open is only available on Linux"),
+    totals(kernels, std::vector<double>()), invocations(kernels, 0) {}
+PerfCounters::~PerfCounters() {}
+void PerfCounters::start() {}
+void PerfCounters::stop(size_t kernel, unsigned int n) {}
+
+#endif
+
+double PerfCounters::mean(size_t kernel, size_t event) const
+{
+  return invocations[kernel] > 0 ? totals[kernel][event] / invocations[kernel] : 0.0;
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Hardware performance counters read around each kernel through Linux perf_event_open.
+// Counts cover the calling thread and the threads it creates after the counters are
+// opened (e.g. an OpenMP or TBB pool started by the first kernel), plus the memory
+// controllers of the whole host for the DRAM read event. Events the host or its
+// perf_event_paranoid setting don't allow are skipped; on other platforms none open.
+class PerfCounters
+{
+  public:
+    explicit PerfCounters(size_t kernels);
+    ~PerfCounters();
+
+    // Names of the events that could be opened
+    const std::vector<std::string>& events() const { return names; }
+
+    // Events that could not be opened and why, empty if all were
+    const std::string& errors() const { return failures; }
+
+    // Start counting for one kernel
+    void start();
+
+    // Stop counting and add the counts to those of a kernel, covering `invocations` calls
+    void stop(size_t kernel, unsigned int invocations = 1);
+
+    // Average count of an event per invocation of a kernel
+    double mean(size_t kernel, size_t event) const;
+
+  private:
+    struct Counter
+    {
+      std::vector<int> fds;   // One per PMU instance and CPU for uncore events
+      double scale;           // Applied to the raw count, e.g. bytes per memory transaction
+    };
+
+    void open(const std::string& name, unsigned int type, unsigned long long config, double scale);
+    void openUncore(const std::string& name, const std::string& event, double scale);
+    double read(const Counter& counter) const;
+
+    std::vector<std::string> names;
+    std::vector<Counter> counters;
+    std::string failures;
+
+    std::vector<double> started;
+    std::vector<std::vector<double>> totals;   // Per kernel, per event
+    std::vector<unsigned long> invocations;    // Per kernel
+};
@@ -0,0 +1,55 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+// Entry point of a model built as a plugin; compiled with the same model
+// definition (e.g. -DOMP) as the single-model driver.
+
+#include "StreamModels.h"
+#include "StreamPlugin.h"
+
+template <typename T>
+static void *make_stream(intptr_t array_size, unsigned int device_index)
+{
+  return make_model_stream<T>(array_size, device_index);
+}
+
+// Constructor of the model for T, nullptr if it is not instantiated for T
+template <typename T>
+static constexpr StreamMaker maker()
+{
+  return ModelHasType<T>::value ? make_stream<T> : nullptr;
+}
+
+static const StreamPlugin plugin = {
+  BABELSTREAM_PLUGIN_ABI,
+  IMPLEMENTATION_STRING,
+  {
+#ifdef STREAM_HAVE_F16
+    maker<float16>(),
+#else
+    nullptr,
+#endif
+    maker<bfloat16>(),
+    maker<float>(),
+    maker<double>(),
+    maker<int32_t>(),
+    maker<int64_t>(),
+    maker<std::complex<float>>(),
+    maker<std::complex<double>>()
+  },
+  listDevices,
+  getDeviceName,
+  getDeviceDriver,
+  setPageMode,
+  setNumaPolicy,
+  setPageReuse,
+  pageUsage
+};
+
+extern "C" const StreamPlugin *babelstream_plugin(void)
+{
+  return &plugin;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "PageAllocator.h"
+
+// Latency kernels for Stream<T>::set_chase and Stream<T>::chase. Each thread owns a list
+// of cache lines linked into one cycle in random order, so that every load depends on
+// the one before and no prefetcher can guess the next line. Following one chain through
+// it measures load latency; following several independent chains at once measures how
+// many misses a core keeps in flight.
+
+#define CHASE_LINE_BYTES 64
+#define CHASE_MAX_CHAINS 16
+
+struct alignas(CHASE_LINE_BYTES) ChaseLine
+{
+  const ChaseLine *next;
+};
+
+// The list of one thread
+class ChaseList
+{
+  public:
+    ChaseList() : lines(nullptr), count(0) {}
+    ~ChaseList() { freePages(lines); }
+    ChaseList(const ChaseList&) = delete;
+    ChaseList& operator=(const ChaseList&) = delete;
+
+    // Allocate and link `bytes` worth of lines, from the thread that will follow them so
+    // that they are first touched where they are used. Every thread's order differs.
+    void build(size_t bytes, unsigned int seed)
+    {
+      freePages(lines);
+      count = bytes / sizeof(ChaseLine) > 0 ? bytes / sizeof(ChaseLine) : 1;
+      lines = static_cast<ChaseLine *>(allocPages(count * sizeof(ChaseLine)));
+
+      std::vector<size_t> order(count);
+      for (size_t i = 0; i < count; i++)
+        order[i] = i;
+      std::mt19937_64 random(seed);
+      for (size_t i = count - 1; i > 0; i--)
+        std::swap(order[i], order[std::uniform_int_distribution<size_t>(0, i)(random)]);
+      for (size_t i = 0; i < count; i++)
+        lines[order[i]].next = &lines[order[(i + 1) % count]];
+
+      // The k-th of n chains starts k / n of the way round the cycle, so that chains
+      // stay as far apart as possible and never run into lines another just loaded
+      for (unsigned int n = 1; n <= CHASE_MAX_CHAINS; n++)
+        for (unsigned int k = 0; k < n; k++)
+          starts[n - 1][k] = &lines[order[k * count / n]];
+    }
+
+    // Follow `chains` chains for `steps` lines each, returns where they ended up combined
+    uintptr_t chase(unsigned int chains, intptr_t steps) const
+    {
+      return dispatch<1>(chains, steps);
+    }
+
+  private:
+    template <unsigned int N>
+    uintptr_t kernel(intptr_t steps) const
+    {
+      const ChaseLine *p[N];
+      for (unsigned int k = 0; k < N; k++)
+        p[k] = starts[N - 1][k];
+      for (intptr_t s = 0; s < steps; s++)
+        for (unsigned int k = 0; k < N; k++)
+          p[k] = p[k]->next;
+      uintptr_t end = 0;
+      for (unsigned int k = 0; k < N; k++)
+        end ^= reinterpret_cast<uintptr_t>(p[k]);
+      return end;
+    }
+
+    // Each number of chains is its own kernel, so that the chains live in registers
+    template <unsigned int N>
+    uintptr_t dispatch(unsigned int chains, intptr_t steps) const
+    {
+      return chains == N ? kernel<N>(steps) : dispatch<N + 1>(chains, steps);
+    }
+
+    ChaseLine *lines;
+    size_t count;
+    const ChaseLine *starts[CHASE_MAX_CHAINS][CHASE_MAX_CHAINS];
+};
+
+template <>
+inline uintptr_t ChaseList::dispatch<CHASE_MAX_CHAINS + 1>(unsigned int, intptr_t) const
+{
+  return 0;
+}
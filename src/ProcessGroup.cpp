@@ -0,0 +1,159 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "ProcessGroup.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Keep the barrier and every slot on their own cache lines
+static const size_t line = 64;
+
+static size_t roundUp(size_t bytes)
+{
+  return (bytes + line - 1) / line * line;
+}
+
+ProcessGroup::ProcessGroup(int workers, size_t slot_bytes)
+  : workers(workers), slot_bytes(roundUp(slot_bytes)), segment(nullptr)
+{
+  segment_bytes = roundUp(sizeof(pthread_barrier_t)) + workers * this->slot_bytes;
+
+  const std::string name = "/babelstream-" + std::to_string(getpid());
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0)
+  {
+    std::cerr << "Error: cannot create shared memory segment " << name << ": " << std::strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  // The mapping outlives the name, so unlink straight away and leave nothing behind in /dev/shm
+  shm_unlink(name.c_str());
+  if (ftruncate(fd, segment_bytes) != 0 ||
+      (segment = mmap(nullptr, segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+  {
+    std::cerr << "Error: cannot map " << segment_bytes << " bytes of shared memory: " << std::strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  close(fd);
+
+  pthread_barrierattr_t attr;
+  pthread_barrierattr_init(&attr);
+  pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  pthread_barrier_init(static_cast<pthread_barrier_t *>(segment), &attr, workers);
+  pthread_barrierattr_destroy(&attr);
+}
+
+ProcessGroup::~ProcessGroup()
+{
+  pthread_barrier_destroy(static_cast<pthread_barrier_t *>(segment));
+  munmap(segment, segment_bytes);
+}
+
+int ProcessGroup::fork()
+{
+  // Anything still buffered would be written once by the parent and once by every child
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+
+  for (int i = 0; i < workers; i++)
+  {
+    pid_t pid = ::fork();
+    if (pid < 0)
+    {
+      std::cerr << "Error: cannot fork worker " << i << ": " << std::strerror(errno) << std::endl;
+      for (pid_t p : pids)
+        kill(p, SIGKILL);
+      exit(EXIT_FAILURE);
+    }
+    if (pid == 0)
+    {
+      pids.clear();
+      return i;
+    }
+    pids.push_back(pid);
+  }
+  return -1;
+}
+
+void ProcessGroup::barrier()
+{
+  pthread_barrier_wait(static_cast<pthread_barrier_t *>(segment));
+}
+
+void *ProcessGroup::slot(int worker)
+{
+  return static_cast<char *>(segment) + roundUp(sizeof(pthread_barrier_t)) + worker * slot_bytes;
+}
+
+int ProcessGroup::wait()
+{
+  int failed = 0;
+  for (size_t remaining = pids.size(); remaining > 0; remaining--)
+  {
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0)
+      break;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+    {
+      if (failed++ == 0)
+        for (pid_t p : pids)
+          if (p != pid)
+            kill(p, SIGKILL);
+    }
+  }
+  pids.clear();
+  return failed;
+}
+
+bool bindToCpus(const std::vector<int>& cpus)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus)
+  {
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+      return false;
+    CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+#else
+
+ProcessGroup::ProcessGroup(int workers, size_t slot_bytes)
+  : workers(workers), slot_bytes(slot_bytes), segment_bytes(0), segment(nullptr)
+{
+  std::cerr << "Error: multi-process mode is only supported on Linux" << std::endl;
+  exit(EXIT_FAILURE);
+}
+
+ProcessGroup::~ProcessGroup() {}
+int ProcessGroup::fork() { return -1; }
+void ProcessGroup::barrier() {}
+void *ProcessGroup::slot(int worker) { return nullptr; }
+int ProcessGroup::wait() { return 0; }
+
+bool bindToCpus(const std::vector<int>& cpus)
+{
+  return false;
+}
+
+#endif
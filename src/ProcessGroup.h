@@ -0,0 +1,46 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <sys/types.h>
+
+// Worker processes forked from the driver, sharing a process-shared barrier and one
+// block of memory per worker in a POSIX shared memory segment (/dev/shm on Linux).
+// Only available on Linux; elsewhere the constructor reports an error and exits.
+class ProcessGroup
+{
+  public:
+    ProcessGroup(int workers, size_t slot_bytes);
+    ~ProcessGroup();
+
+    // Fork the workers; returns the index of the worker in each child and -1 in the parent.
+    // Workers must leave with _exit() so that buffered output of the parent isn't repeated.
+    int fork();
+
+    // Block until all workers have reached the barrier; only called by workers
+    void barrier();
+
+    // Shared block of a worker, slot_bytes long and zero-initialised
+    void *slot(int worker);
+
+    // Wait for all workers to exit, returns the number that failed. If one fails the rest
+    // are killed, as they would otherwise wait at the barrier forever.
+    int wait();
+
+  private:
+    int workers;
+    size_t slot_bytes;
+    size_t segment_bytes;
+    void *segment;
+    std::vector<pid_t> pids;
+};
+
+// Restrict the calling process, and any threads it creates from then on, to the given CPUs
+bool bindToCpus(const std::vector<int>& cpus);
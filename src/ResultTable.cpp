@@ -0,0 +1,95 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "ResultTable.h"
+
+#include <iomanip>
+#include <iostream>
+
+ResultTable::ResultTable(const std::vector<TableColumn>& columns, const std::string& csv_path,
+                         const std::string& separator)
+  : columns(columns), csv(nullptr), separator(separator)
+{
+  if (!csv_path.empty())
+  {
+    csv_file.reset(new std::ofstream(csv_path));
+    csv = csv_file.get();
+  }
+  header();
+}
+
+ResultTable::ResultTable(const std::vector<TableColumn>& columns, std::ostream *csv,
+                         const std::string& separator)
+  : columns(columns), csv(csv), separator(separator)
+{
+  header();
+}
+
+void ResultTable::header()
+{
+  printed = false;
+  for (const TableColumn& column : columns)
+    printed = printed || !column.heading.empty();
+
+  if (csv)
+  {
+    bool first = true;
+    for (const TableColumn& column : columns)
+    {
+      if (column.csv.empty())
+        continue;
+      *csv << (first ? "" : separator) << column.csv;
+      first = false;
+    }
+    *csv << std::endl;
+  }
+
+  if (!printed)
+    return;
+  for (const TableColumn& column : columns)
+    if (!column.heading.empty())
+      std::cout << std::left << std::setw(column.width) << column.heading;
+  std::cout << std::endl;
+}
+
+void ResultTable::row(const std::vector<TableCell>& cells)
+{
+  if (csv)
+  {
+    bool first = true;
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+      if (columns[i].csv.empty())
+        continue;
+      *csv << (first ? "" : separator);
+      if (cells[i].real)
+        *csv << cells[i].value;
+      else
+        *csv << cells[i].text;
+      first = false;
+    }
+    *csv << std::endl;
+  }
+
+  if (!printed)
+    return;
+  const std::ios_base::fmtflags flags = std::cout.flags();
+  const std::streamsize precision = std::cout.precision();
+  std::cout << std::fixed;
+  for (size_t i = 0; i < columns.size(); i++)
+  {
+    if (columns[i].heading.empty())
+      continue;
+    std::cout << std::left << std::setw(columns[i].width);
+    if (cells[i].real)
+      std::cout << std::setprecision(columns[i].precision) << cells[i].value;
+    else
+      std::cout << cells[i].text;
+  }
+  std::cout << std::endl;
+  std::cout.flags(flags);
+  std::cout.precision(precision);
+}
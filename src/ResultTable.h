@@ -0,0 +1,65 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Column of a ResultTable
+struct TableColumn
+{
+  std::string csv;      // Name in the CSV header, empty if the column is only printed
+  std::string heading;  // Printed heading, empty if the column is only in the CSV file
+  int width;            // Printed width
+  int precision;        // Printed digits after the point of real numbers
+};
+
+// Value of one column in a row: text, a whole number, or a real number
+struct TableCell
+{
+  TableCell(const std::string& text) : text(text), real(false), value(0.0) {}
+  TableCell(const char *text) : text(text), real(false), value(0.0) {}
+  TableCell(double value) : real(true), value(value) {}
+  template <typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+  TableCell(I value) : text(std::to_string(value)), real(false), value(0.0) {}
+
+  std::string text;
+  bool real;
+  double value;
+};
+
+// Results of a run, one row per measurement, printed as a table with fixed point numbers
+// and, if a CSV file is given, written to it with the CSV header first. The columns of
+// each row appear in both, apart from those only one of them names; a table without
+// headings prints nothing.
+class ResultTable
+{
+  public:
+    // Prints the headings and, if csv_path is not empty, writes the CSV header to that file
+    ResultTable(const std::vector<TableColumn>& columns, const std::string& csv_path,
+                const std::string& separator);
+
+    // As above, but writing the CSV to csv, which may be null, shared with other tables
+    ResultTable(const std::vector<TableColumn>& columns, std::ostream *csv,
+                const std::string& separator);
+
+    // Print and write one row, with a value for every column
+    void row(const std::vector<TableCell>& cells);
+
+  private:
+    void header();
+
+    std::vector<TableColumn> columns;
+    std::unique_ptr<std::ofstream> csv_file;
+    std::ostream *csv;
+    std::string separator;
+    bool printed;
+};
@@ -0,0 +1,64 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+// Roofline kernel: triad followed by K dependent multiply-adds per element,
+//   x = b[i] + scalar * c[i]; x = x * scalar + c[i] (K times); a[i] = x
+// which moves the same bytes as triad while doing 2 + 2K flops per element.
+// Each K is compiled as its own kernel so that the chain is fully unrolled.
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+#define ROOFLINE_INLINE __host__ __device__ inline
+#else
+#define ROOFLINE_INLINE inline
+#endif
+
+// x = x * scalar + c applied K times. Unrolled through templates rather than a loop,
+// which compilers stop unrolling at a few iterations, leaving the loop over elements
+// unvectorised and turning the kernel latency bound long before it is compute bound.
+// x may be of a wider type than T, as with bfloat16 arithmetic done in float; each step
+// is stored back to T.
+template <unsigned int K>
+struct RooflineChain
+{
+  template <typename X, typename T>
+  static ROOFLINE_INLINE T apply(X x, const T c, const T scalar)
+  {
+    return RooflineChain<K - 1>::apply(T(T(x) * scalar + c), c, scalar);
+  }
+};
+
+template <>
+struct RooflineChain<0>
+{
+  template <typename X, typename T>
+  static ROOFLINE_INLINE T apply(X x, const T, const T)
+  {
+    return T(x);
+  }
+};
+
+// Values of K for which Stream<T>::roofline is compiled, in increasing order
+static const unsigned int roofline_fmas[] = {0, 1, 2, 4, 8, 16, 32, 64, 128, 256};
+
+// Body of `bool roofline(unsigned int fmas)` in a model: call the member template
+// KERNEL<K>() for K == fmas and return true, or return false if fmas is not compiled
+#define ROOFLINE_DISPATCH(fmas, KERNEL)  \
+  switch (fmas)                          \
+  {                                      \
+    case 0: KERNEL<0>(); return true;    \
+    case 1: KERNEL<1>(); return true;    \
+    case 2: KERNEL<2>(); return true;    \
+    case 4: KERNEL<4>(); return true;    \
+    case 8: KERNEL<8>(); return true;    \
+    case 16: KERNEL<16>(); return true;  \
+    case 32: KERNEL<32>(); return true;  \
+    case 64: KERNEL<64>(); return true;  \
+    case 128: KERNEL<128>(); return true; \
+    case 256: KERNEL<256>(); return true; \
+    default: return false;               \
+  }
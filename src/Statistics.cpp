@@ -0,0 +1,102 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "Statistics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// Two-sided 97.5% quantile of Student's t distribution with df degrees of freedom
+static double studentT975(size_t df)
+{
+  static const double table[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (df == 0)
+    return 0.0;
+  if (df <= sizeof(table) / sizeof(table[0]))
+    return table[df - 1];
+
+  // Cornish-Fisher expansion around the normal quantile
+  const double z = 1.959964;
+  const double n = static_cast<double>(df);
+  return z + (z*z*z + z) / (4.0 * n) + (5.0*std::pow(z, 5) + 16.0*z*z*z + 3.0*z) / (96.0 * n * n);
+}
+
+// Percentile of sorted samples, interpolating linearly between closest ranks
+static double percentile(const std::vector<double>& sorted, double p)
+{
+  const double rank = p * (sorted.size() - 1);
+  const size_t lower = static_cast<size_t>(rank);
+  if (lower + 1 >= sorted.size())
+    return sorted.back();
+  return sorted[lower] + (rank - lower) * (sorted[lower + 1] - sorted[lower]);
+}
+
+double measureTimerOverhead()
+{
+  double overhead = std::numeric_limits<double>::max();
+  for (int i = 0; i < 1000; i++)
+  {
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    overhead = std::min(overhead, std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count());
+  }
+  return overhead;
+}
+
+Statistics computeStatistics(std::vector<double> samples, double timer_overhead)
+{
+  Statistics stats = {};
+  stats.count = samples.size();
+  if (samples.empty())
+    return stats;
+
+  std::sort(samples.begin(), samples.end());
+  stats.min = samples.front();
+  stats.max = samples.back();
+  stats.median = percentile(samples, 0.50);
+  stats.p5 = percentile(samples, 0.05);
+  stats.p95 = percentile(samples, 0.95);
+  stats.p99 = percentile(samples, 0.99);
+  stats.min_corrected = std::max(stats.min - timer_overhead, 0.0);
+
+  double sum = 0.0;
+  for (double s : samples)
+    sum += s;
+  stats.mean = sum / samples.size();
+
+  double squares = 0.0;
+  for (double s : samples)
+    squares += (s - stats.mean) * (s - stats.mean);
+  stats.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0.0;
+  stats.cv = stats.mean > 0.0 ? stats.stddev / stats.mean : 0.0;
+
+  const double half_width = studentT975(samples.size() - 1) * stats.stddev / std::sqrt((double)samples.size());
+  // The mean cannot lie below the fastest sample, which also keeps the bound from going to
+  // 0 or below on few noisy samples and turning the bandwidth bound derived from it negative
+  stats.ci95_low = std::max(stats.mean - half_width, stats.min);
+  stats.ci95_high = stats.mean + half_width;
+
+  return stats;
+}
+
+bool isSteadyState(const std::vector<double>& samples, size_t window, double tolerance)
+{
+  if (window < 2 || samples.size() < 2 * window)
+    return false;
+
+  const std::vector<double> previous(samples.end() - 2 * window, samples.end() - window);
+  const std::vector<double> current(samples.end() - window, samples.end());
+  const Statistics p = computeStatistics(previous, 0.0);
+  const Statistics c = computeStatistics(current, 0.0);
+
+  return std::fabs(c.cv - p.cv) <= tolerance &&
+         std::fabs(c.mean - p.mean) <= std::max(c.cv, p.cv) * p.mean;
+}
@@ -0,0 +1,39 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Summary of a set of kernel runtimes, all in seconds
+struct Statistics
+{
+  size_t count;
+  double min;
+  double max;
+  double mean;
+  double median;
+  double p5;
+  double p95;
+  double p99;
+  double stddev;          // Sample standard deviation
+  double cv;              // Coefficient of variation (stddev / mean)
+  double min_corrected;   // Minimum with the timer overhead subtracted
+  double ci95_low;        // 95% confidence interval on the mean, Student's t, with the
+  double ci95_high;       // low end no lower than min
+};
+
+// Smallest observed cost of a pair of back-to-back timer reads, in seconds
+double measureTimerOverhead();
+
+// Summarise samples; a single sample yields a zero-width interval
+Statistics computeStatistics(std::vector<double> samples, double timer_overhead);
+
+// Whether the last two windows of samples look alike: their coefficients of variation
+// differ by at most `tolerance` and their means differ by less than the larger CV.
+// Needs at least 2 * window samples.
+bool isSteadyState(const std::vector<double>& samples, size_t window, double tolerance);
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -38,6 +39,87 @@ class Stream
     virtual void init_arrays(T initA, T initB, T initC) = 0;
     virtual void read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) = 0;
 
+    // Restrict all kernels, init_arrays and read_arrays to the first n elements,
+    // where n must not exceed the size the stream was constructed with.
+    // Returns false if the implementation does not support this.
+    virtual bool set_array_size(intptr_t /*n*/) { return false; }
+
+    // Mean absolute difference of the elements of a, b and c from goldA, goldB and goldC,
+    // computed in place without copying the arrays back.
+    // Returns false if the implementation does not support this; use read_arrays instead.
+    virtual bool validate(T /*goldA*/, T /*goldB*/, T /*goldC*/, double& /*errA*/, double& /*errB*/, double& /*errC*/) { return false; }
+
+    // Run subsequent kernels on n threads.
+    // Returns false if the implementation cannot change its thread count at runtime.
+    virtual bool set_num_threads(int /*n*/) { return false; }
+
+    // Triad followed by `fmas` dependent multiply-adds per element, see Roofline.h.
+    // Returns false if the implementation does not support this or `fmas` is not compiled.
+    virtual bool roofline(unsigned int /*fmas*/) { return false; }
+
+    // Read `reads` and write `writes` arrays kept apart from a, b and c, with sum set to
+    // the sum of the inputs, see MixKernels.h.
+    // Returns false if the implementation does not support this or the mix is too large.
+    virtual bool mix(unsigned int /*reads*/, unsigned int /*writes*/, T& /*sum*/) { return false; }
+
+    // Copy (c[i] = a[i]) and triad (a[i] = b[i] + scalar * c[i]) applied only to every
+    // stride-th element, i = 0, stride, 2 * stride, ...
+    // Return false if the implementation does not support this.
+    virtual bool strided_copy(intptr_t /*stride*/) { return false; }
+    virtual bool strided_triad(intptr_t /*stride*/) { return false; }
+
+    // As validate, but comparing elements i = 0, stride, 2 * stride, ... with stridedA,
+    // stridedB and stridedC instead, to check the arrays after the strided kernels.
+    // Returns false if the implementation does not support this; use read_arrays instead.
+    virtual bool validate_strided(intptr_t /*stride*/, T /*stridedA*/, T /*stridedB*/, T /*stridedC*/,
+                                  T /*goldA*/, T /*goldB*/, T /*goldC*/,
+                                  double& /*errA*/, double& /*errB*/, double& /*errC*/) { return false; }
+
+    // Index array of the gather and scatter kernels: array_size indices below array_size,
+    // to be set again after set_array_size.
+    // Returns false if the implementation does not support gather and scatter.
+    virtual bool set_indices(const std::vector<intptr_t>& /*indices*/) { return false; }
+
+    // Gather (a[i] = b[idx[i]]) and scatter (a[idx[i]] = b[i]) through the index array.
+    // Return false if the implementation does not support this.
+    virtual bool gather() { return false; }
+    virtual bool scatter() { return false; }
+
+    // Write the results of copy, mul, add, triad and nstream with non-temporal (streaming)
+    // stores, which skip the read of each line before it is written, or with regular stores.
+    // Returns false if the implementation cannot choose its stores at runtime.
+    virtual bool set_nontemporal(bool /*enabled*/) { return false; }
+
+    // Give the threads on each NUMA node their own copy of their part of the arrays,
+    // allocated on that node, or share one set of arrays again. Contents are lost, so
+    // call init_arrays afterwards.
+    // Returns false if the implementation cannot replicate its arrays.
+    virtual bool set_replicated(bool /*enabled*/) { return false; }
+
+    // Repeat the sweep of copy, mul, add, triad, nstream and dot `reps` times within one
+    // call, each thread going over its own part of the arrays again without waiting for
+    // the others, so that the cost of starting a parallel kernel is spread over reps
+    // sweeps of arrays small enough to stay in cache. nstream then updates a reps times
+    // per call, and dot returns the result of one sweep.
+    // Returns false if the implementation cannot repeat its kernels.
+    virtual bool set_inner_reps(unsigned int /*reps*/) { return false; }
+
+    // Pin thread i of subsequent kernels to cpus[i % cpus.size()], including after
+    // set_num_threads. Call before init_arrays, so that pages are first touched by the
+    // threads that will use them.
+    // Returns false if the implementation cannot place its threads.
+    virtual bool set_affinity(const std::vector<int>& /*cpus*/) { return false; }
+
+    // Give each thread of subsequent kernels its own list of `bytes` bytes of cache lines
+    // linked in random order, see PointerChase.h; set again after set_num_threads.
+    // Returns false if the implementation does not support the latency kernels.
+    virtual bool set_chase(size_t /*bytes*/) { return false; }
+
+    // Every thread follows `chains` independent chains, at most CHASE_MAX_CHAINS, through
+    // its list for `steps` lines each.
+    // Returns false if the implementation does not support this.
+    virtual bool chase(unsigned int /*chains*/, intptr_t /*steps*/) { return false; }
+
 };
 
 
@@ -0,0 +1,152 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+// Selects the implementation from the model definition passed by the build
+// (e.g. -DOMP) and provides a factory for it. Shared between the single-model
+// driver and the model plugins.
+
+#include <type_traits>
+
+#include "Stream.h"
+#include "StreamTypes.h"
+
+#if defined(CUDA)
+#include "CUDAStream.h"
+#elif defined(STD_DATA)
+#include "STDDataStream.h"
+#elif defined(STD_INDICES)
+#include "STDIndicesStream.h"
+#elif defined(STD_RANGES)
+#include "STDRangesStream.hpp"
+#elif defined(TBB)
+#include "TBBStream.hpp"
+#elif defined(THRUST)
+#include "ThrustStream.h"
+#elif defined(HIP)
+#include "HIPStream.h"
+#elif defined(HC)
+#include "HCStream.h"
+#elif defined(OCL)
+#include "OCLStream.h"
+#elif defined(USE_RAJA)
+#include "RAJAStream.hpp"
+#elif defined(KOKKOS)
+#include "KokkosStream.hpp"
+#elif defined(ACC)
+#include "ACCStream.h"
+#elif defined(SYCL)
+#include "SYCLStream.h"
+#elif defined(SYCL2020)
+#include "SYCLStream2020.h"
+#elif defined(OMP)
+#include "OMPStream.h"
+#elif defined(SIMD)
+#include "SIMDStream.h"
+#elif defined(THREADS)
+#include "ThreadsStream.h"
+#elif defined(FUTHARK)
+#include "FutharkStream.h"
+#endif
+
+// Whether the selected implementation is instantiated for element type T
+template <typename T>
+struct ModelHasType : std::integral_constant<bool,
+#ifdef STREAM_EXTRA_TYPES
+  true
+#else
+  std::is_same<T, float>::value || std::is_same<T, double>::value
+#endif
+  > {};
+
+// Construct the selected implementation with the given array size, nullptr if it is
+// not instantiated for T
+template <typename T>
+Stream<T> *make_model_stream(intptr_t array_size, unsigned int device_index, std::false_type)
+{
+  return nullptr;
+}
+
+template <typename T>
+Stream<T> *make_model_stream(intptr_t array_size, unsigned int device_index, std::true_type)
+{
+#if defined(CUDA)
+  // Use the CUDA implementation
+  return new CUDAStream<T>(array_size, device_index);
+
+#elif defined(HIP)
+  // Use the HIP implementation
+  return new HIPStream<T>(array_size, device_index);
+
+#elif defined(HC)
+  // Use the HC implementation
+  return new HCStream<T>(array_size, device_index);
+
+#elif defined(OCL)
+  // Use the OpenCL implementation
+  return new OCLStream<T>(array_size, device_index);
+
+#elif defined(USE_RAJA)
+  // Use the RAJA implementation
+  return new RAJAStream<T>(array_size, device_index);
+
+#elif defined(KOKKOS)
+  // Use the Kokkos implementation
+  return new KokkosStream<T>(array_size, device_index);
+
+#elif defined(STD_DATA)
+  // Use the C++ STD data-oriented implementation
+  return new STDDataStream<T>(array_size, device_index);
+
+#elif defined(STD_INDICES)
+  // Use the C++ STD index-oriented implementation
+  return new STDIndicesStream<T>(array_size, device_index);
+
+#elif defined(STD_RANGES)
+  // Use the C++ STD ranges implementation
+  return new STDRangesStream<T>(array_size, device_index);
+
+#elif defined(TBB)
+  // Use the C++20 implementation
+  return new TBBStream<T>(array_size, device_index);
+
+#elif defined(THRUST)
+  // Use the Thrust implementation
+  return new ThrustStream<T>(array_size, device_index); 
+
+#elif defined(ACC)
+  // Use the OpenACC implementation
+  return new ACCStream<T>(array_size, device_index);
+
+#elif defined(SYCL) || defined(SYCL2020)
+  // Use the SYCL implementation
+  return new SYCLStream<T>(array_size, device_index);
+
+#elif defined(OMP)
+  // Use the OpenMP implementation
+  return new OMPStream<T>(array_size, device_index);
+
+#elif defined(SIMD)
+  // Use the hand-vectorised implementation
+  return new SIMDStream<T>(array_size, device_index);
+
+#elif defined(THREADS)
+  // Use the std::thread pool implementation
+  return new ThreadsStream<T>(array_size, device_index);
+
+#elif defined(FUTHARK)
+  // Use the Futhark implementation
+  return new FutharkStream<T>(array_size, device_index);
+
+#endif
+}
+
+template <typename T>
+Stream<T> *make_model_stream(intptr_t array_size, unsigned int device_index)
+{
+  return make_model_stream<T>(array_size, device_index, ModelHasType<T>());
+}
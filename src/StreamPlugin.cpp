@@ -0,0 +1,119 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "StreamPlugin.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <unistd.h>
+
+static const std::string plugin_prefix = "libbabelstream-";
+static const std::string plugin_suffix = ".so";
+
+// Directories to search for plugins, in order
+static std::vector<std::string> searchPath()
+{
+  std::vector<std::string> dirs;
+
+  char exe[4096];
+  ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  if (len > 0)
+  {
+    std::string dir(exe, len);
+    dir = dir.substr(0, dir.find_last_of('/'));
+    dirs.push_back(dir);
+    dirs.push_back(dir + "/../lib");
+  }
+
+  if (const char *env = std::getenv("BABELSTREAM_PLUGIN_PATH"))
+  {
+    std::stringstream ss(env);
+    std::string dir;
+    while (std::getline(ss, dir, ':'))
+      if (!dir.empty())
+        dirs.push_back(dir);
+  }
+
+  return dirs;
+}
+
+const StreamPlugin *loadStreamPlugin(const std::string& model)
+{
+  std::vector<std::string> candidates;
+  if (model.find('/') != std::string::npos)
+    candidates.push_back(model);
+  else
+  {
+    const std::string file = plugin_prefix + model + plugin_suffix;
+    for (const std::string& dir : searchPath())
+      candidates.push_back(dir + "/" + file);
+    // Fall back to the dynamic linker's own search (LD_LIBRARY_PATH etc.)
+    candidates.push_back(file);
+  }
+
+  std::string errors;
+  for (const std::string& candidate : candidates)
+  {
+    // Keep each plugin's symbols private so that models cannot interpose on each other
+    void *handle = dlopen(candidate.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+    {
+      errors += std::string("\n  ") + dlerror();
+      continue;
+    }
+
+    typedef const StreamPlugin *(*entry_t)(void);
+    entry_t entry = reinterpret_cast<entry_t>(dlsym(handle, BABELSTREAM_PLUGIN_ENTRY));
+    if (!entry)
+    {
+      std::cerr << "Error: " << candidate << " is not a BabelStream plugin" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    const StreamPlugin *plugin = entry();
+    if (plugin->abi != BABELSTREAM_PLUGIN_ABI)
+    {
+      std::cerr << "Error: " << candidate << " was built for plugin ABI " << plugin->abi
+        << ", expected " << BABELSTREAM_PLUGIN_ABI << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    return plugin;
+  }
+
+  std::cerr << "Error: cannot load model '" << model << "'" << errors << std::endl;
+  exit(EXIT_FAILURE);
+}
+
+std::vector<std::string> findStreamPlugins()
+{
+  std::vector<std::string> models;
+  for (const std::string& dir : searchPath())
+  {
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+      continue;
+    while (struct dirent *entry = readdir(d))
+    {
+      std::string name = entry->d_name;
+      if (name.size() > plugin_prefix.size() + plugin_suffix.size() &&
+          name.compare(0, plugin_prefix.size(), plugin_prefix) == 0 &&
+          name.compare(name.size() - plugin_suffix.size(), plugin_suffix.size(), plugin_suffix) == 0)
+      {
+        name = name.substr(plugin_prefix.size(), name.size() - plugin_prefix.size() - plugin_suffix.size());
+        if (std::find(models.begin(), models.end(), name) == models.end())
+          models.push_back(name);
+      }
+    }
+    closedir(d);
+  }
+  std::sort(models.begin(), models.end());
+  return models;
+}
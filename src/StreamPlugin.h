@@ -0,0 +1,60 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Stream.h"
+#include "StreamTypes.h"
+#include "PageAllocator.h"
+
+// Interface between the babelstream driver and a model built as a shared-object plugin
+// (libbabelstream-<model>.so, see PLUGIN_MODELS in CMakeLists.txt).
+// Bump the ABI version whenever this struct or Stream<T> changes.
+#define BABELSTREAM_PLUGIN_ABI 12
+#define BABELSTREAM_PLUGIN_ENTRY "babelstream_plugin"
+
+// Constructs a Stream<T> of the model for one ElementType, returned as void *
+typedef void *(*StreamMaker)(intptr_t array_size, unsigned int device_index);
+
+struct StreamPlugin
+{
+  int abi;
+  const char *implementation;
+  // Constructor of a Stream<T> for each ElementType, see makePluginStream; nullptr for
+  // types the model is not instantiated for
+  StreamMaker make[ELEMENT_TYPES];
+  void (*list_devices)(void);
+  std::string (*device_name)(const int);
+  std::string (*device_driver)(const int);
+  // The plugin's own copy of the page allocator, see PageAllocator.h
+  void (*set_page_mode)(PageMode mode);
+  void (*set_numa_policy)(NumaPolicy policy, int node);
+  void (*set_page_reuse)(bool enabled);
+  PageUsage (*page_usage)(void);
+};
+
+// Construct the model of a plugin for element type T, nullptr if it does not have T
+template <typename T>
+Stream<T> *makePluginStream(const StreamPlugin *plugin, intptr_t array_size, unsigned int device_index)
+{
+  const StreamMaker make = plugin->make[(int)Element<T>::type];
+  return make ? static_cast<Stream<T> *>(make(array_size, device_index)) : nullptr;
+}
+
+// Exported by every plugin
+extern "C" const StreamPlugin *babelstream_plugin(void);
+
+// Load the plugin for a model name, e.g. "omp", or a path to a plugin.
+// Plugins are searched for next to the executable, in ../lib relative to it, in the
+// directories of BABELSTREAM_PLUGIN_PATH, and finally on the default library path.
+// Exits with an error message if the plugin cannot be loaded.
+const StreamPlugin *loadStreamPlugin(const std::string& model);
+
+// Names of all plugins found on the search path
+std::vector<std::string> findStreamPlugins();
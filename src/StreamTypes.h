@@ -0,0 +1,227 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Stream.h"
+
+// Element types the kernels can run on, see --type. Every model is instantiated for
+// float and double; models that define STREAM_EXTRA_TYPES in their header are also
+// instantiated for the others with STREAM_INSTANTIATE_EXTRA_TYPES.
+enum class ElementType { F16, BF16, F32, F64, I32, I64, C32, C64 };
+#define ELEMENT_TYPES 8
+
+// Name of each ElementType, as given to --type
+inline const char *elementTypeName(ElementType type)
+{
+  static const char *const names[ELEMENT_TYPES] = {"f16", "bf16", "f32", "f64", "i32", "i64", "c32", "c64"};
+  return names[(int)type];
+}
+
+// Parse a comma-separated list of names, or "all", returns false on malformed input.
+// "all" lists the types by decreasing size, so that allocations can be reused by the
+// next type of the same size.
+inline bool parseElementTypes(const std::string& spec, std::vector<ElementType>& types)
+{
+  types.clear();
+  if (spec == "all")
+  {
+    types = {ElementType::C64, ElementType::F64, ElementType::I64, ElementType::C32,
+             ElementType::F32, ElementType::I32, ElementType::F16, ElementType::BF16};
+    return true;
+  }
+  size_t begin = 0;
+  while (begin <= spec.size())
+  {
+    const size_t end = std::min(spec.find(',', begin), spec.size());
+    const std::string name = spec.substr(begin, end - begin);
+    int t = 0;
+    while (t < ELEMENT_TYPES && name != elementTypeName((ElementType)t))
+      t++;
+    if (t == ELEMENT_TYPES)
+      return false;
+    types.push_back((ElementType)t);
+    begin = end + 1;
+  }
+  return true;
+}
+
+// f16 is the compiler's _Float16, where it has one and the C++ runtime has its type info,
+// which libstdc++ only has from GCC 13
+#if defined(__FLT16_MAX__) && !(defined(_GLIBCXX_RELEASE) && _GLIBCXX_RELEASE < 13)
+#define STREAM_HAVE_F16
+typedef _Float16 float16;
+#endif
+
+// The upper half of a float, rounded to nearest even. Arithmetic converts to float, so
+// an expression rounds once, when it is stored back, as with _Float16.
+struct bfloat16
+{
+  uint16_t bits;
+
+  bfloat16() : bits(0) {}
+  bfloat16(float x)
+  {
+    uint32_t u;
+    std::memcpy(&u, &x, sizeof(u));
+    if ((u & 0x7fffffff) > 0x7f800000)
+      bits = (u >> 16) | 0x40;  // Keep NaN a quiet NaN
+    else
+      bits = (u + 0x7fff + ((u >> 16) & 1)) >> 16;
+  }
+
+  operator float() const
+  {
+    const uint32_t u = (uint32_t)bits << 16;
+    float x;
+    std::memcpy(&x, &u, sizeof(x));
+    return x;
+  }
+
+  bfloat16& operator+=(float x) { return *this = float(*this) + x; }
+  bfloat16& operator-=(float x) { return *this = float(*this) - x; }
+  bfloat16& operator*=(float x) { return *this = float(*this) * x; }
+  bfloat16& operator/=(float x) { return *this = float(*this) / x; }
+};
+
+// Absolute value of an element, or of the difference of two, as a double
+template <typename T>
+inline double element_abs(T x) { return std::fabs((double)x); }
+template <typename T>
+inline double element_abs(std::complex<T> x) { return (double)std::abs(x); }
+inline long double element_abs(long double x) { return std::fabs(x); }
+inline long double element_abs(std::complex<long double> x) { return std::abs(x); }
+
+// Properties of each element type:
+//   type, name()      its ElementType and --type name
+//   description()     as printed in results, "float" and "double" as before
+//   epsilon(), max()  of its real part; epsilon is 0 for integers, which must be exact
+//   Wide              type to compute expected sums in without rounding or overflow
+//   Sum               type the dot product accumulates in: the element type, but double
+//                     for 16-bit types, whose sums stop growing after a few hundred terms
+//   MixSum            type the mix kernels add their inputs and sums in: double, or its
+//                     complex, for floating point types, the element type for integers
+//   initA(), initB(), initC(), scalar()
+//                     initial values and scalar of the kernels, startA ... startScalar
+//                     but for integers
+template <typename T> struct Element;
+
+template <typename T, ElementType E>
+struct FloatElement
+{
+  static const ElementType type = E;
+  static const char *name() { return elementTypeName(E); }
+  typedef long double Wide;
+  typedef T Sum;
+  typedef double MixSum;
+  static T initA() { return T(startA); }
+  static T initB() { return T(startB); }
+  static T initC() { return T(startC); }
+  static T scalar() { return T(startScalar); }
+};
+
+#ifdef STREAM_HAVE_F16
+template <> struct Element<float16> : FloatElement<float16, ElementType::F16>
+{
+  typedef double Sum;
+  static const char *description() { return "half (_Float16)"; }
+  static long double epsilon() { return std::ldexp(1.0L, -10); }
+  static long double max() { return 65504.0L; }
+};
+#endif
+
+template <> struct Element<bfloat16> : FloatElement<bfloat16, ElementType::BF16>
+{
+  typedef double Sum;
+  static const char *description() { return "bfloat16"; }
+  static long double epsilon() { return std::ldexp(1.0L, -7); }
+  static long double max() { return std::ldexp(255.0L, 120); }
+};
+
+template <> struct Element<float> : FloatElement<float, ElementType::F32>
+{
+  static const char *description() { return "float"; }
+  static long double epsilon() { return std::numeric_limits<float>::epsilon(); }
+  static long double max() { return std::numeric_limits<float>::max(); }
+};
+
+template <> struct Element<double> : FloatElement<double, ElementType::F64>
+{
+  static const char *description() { return "double"; }
+  static long double epsilon() { return std::numeric_limits<double>::epsilon(); }
+  static long double max() { return std::numeric_limits<double>::max(); }
+};
+
+// 0.4 truncates to 0, so integers use a scalar of -1: each iteration of the 5 kernels
+// then leaves c[] at 0 and flips the sign of a[], whose values stay exact and bounded
+template <typename T, ElementType E>
+struct IntegerElement
+{
+  static const ElementType type = E;
+  static const char *name() { return elementTypeName(E); }
+  typedef long double Wide;
+  typedef T Sum;
+  typedef T MixSum;
+  static long double epsilon() { return 0.0L; }
+  static long double max() { return (long double)std::numeric_limits<T>::max(); }
+  static T initA() { return 1; }
+  static T initB() { return 2; }
+  static T initC() { return 0; }
+  static T scalar() { return -1; }
+};
+
+template <> struct Element<int32_t> : IntegerElement<int32_t, ElementType::I32>
+{
+  static const char *description() { return "int32"; }
+};
+
+template <> struct Element<int64_t> : IntegerElement<int64_t, ElementType::I64>
+{
+  static const char *description() { return "int64"; }
+};
+
+template <typename R, ElementType E>
+struct ComplexElement : FloatElement<std::complex<R>, E>
+{
+  typedef std::complex<long double> Wide;
+  typedef std::complex<double> MixSum;
+  static long double epsilon() { return std::numeric_limits<R>::epsilon(); }
+  static long double max() { return std::numeric_limits<R>::max(); }
+};
+
+template <> struct Element<std::complex<float>> : ComplexElement<float, ElementType::C32>
+{
+  static const char *description() { return "complex float"; }
+};
+
+template <> struct Element<std::complex<double>> : ComplexElement<double, ElementType::C64>
+{
+  static const char *description() { return "complex double"; }
+};
+
+#ifdef STREAM_HAVE_F16
+#define STREAM_INSTANTIATE_F16(S) template class S<float16>;
+#else
+#define STREAM_INSTANTIATE_F16(S)
+#endif
+
+// Explicit instantiations of a model for the element types beyond float and double
+#define STREAM_INSTANTIATE_EXTRA_TYPES(S) \
+  STREAM_INSTANTIATE_F16(S) \
+  template class S<bfloat16>; \
+  template class S<int32_t>; \
+  template class S<int64_t>; \
+  template class S<std::complex<float>>; \
+  template class S<std::complex<double>>;
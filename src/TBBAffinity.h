@@ -0,0 +1,33 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <vector>
+
+#include <tbb/task_arena.h>
+#include <tbb/task_scheduler_observer.h>
+
+#include "Affinity.h"
+
+// Pins each thread entering the arena of the thread that creates it, usually the default
+// arena, to cpus[slot % cpus.size()], where slot is its index in the arena. The creating
+// thread is pinned at once; TBB has no way to reach workers already in the arena, which
+// are pinned when they next enter it, after running out of work.
+class TBBPinObserver : public tbb::task_scheduler_observer
+{
+  public:
+    explicit TBBPinObserver(const std::vector<int>& cpus) : cpus(cpus) { observe(true); }
+    ~TBBPinObserver() { observe(false); }
+
+    void on_scheduler_entry(bool) override
+    {
+      pinThread(cpus[tbb::this_task_arena::current_thread_index() % cpus.size()]);
+    }
+
+  private:
+    const std::vector<int> cpus;
+};
@@ -0,0 +1,204 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "Topology.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+static const std::string sysfs_cpu = "/sys/devices/system/cpu";
+static const std::string sysfs_node = "/sys/devices/system/node";
+
+// Read the first line of a sysfs file, empty if it doesn't exist
+static std::string readLine(const std::string& path)
+{
+  std::ifstream file(path);
+  std::string line;
+  if (file)
+    std::getline(file, line);
+  return line;
+}
+
+// Parse sizes such as "48K" or "32M" into bytes
+static size_t parseSize(const std::string& str)
+{
+  char *next;
+  size_t size = std::strtoull(str.c_str(), &next, 10);
+  switch (*next)
+  {
+    case 'K': return size << 10;
+    case 'M': return size << 20;
+    case 'G': return size << 30;
+    default:  return size;
+  }
+}
+
+std::vector<int> parseCpuList(const std::string& list)
+{
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ','))
+  {
+    if (range.empty())
+      continue;
+    char *next;
+    long first = std::strtol(range.c_str(), &next, 10);
+    long last = first;
+    if (*next == '-')
+      last = std::strtol(next + 1, &next, 10);
+    if (*next != '\0' || first < 0 || last < first)
+      return {};
+    for (long cpu = first; cpu <= last; cpu++)
+      cpus.push_back(static_cast<int>(cpu));
+  }
+  return cpus;
+}
+
+std::string formatCpuList(std::vector<int> cpus)
+{
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+  std::string list;
+  for (size_t i = 0; i < cpus.size();)
+  {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+      j++;
+    if (!list.empty())
+      list += ",";
+    list += std::to_string(cpus[i]);
+    if (j > i)
+      list += "-" + std::to_string(cpus[j]);
+    i = j + 1;
+  }
+  return list;
+}
+
+std::vector<int> onlineCpus()
+{
+  return parseCpuList(readLine(sysfs_cpu + "/online"));
+}
+
+std::vector<std::vector<int>> numaNodeCpus()
+{
+  std::vector<std::vector<int>> nodes;
+  for (int node : parseCpuList(readLine(sysfs_node + "/online")))
+  {
+    std::vector<int> cpus = parseCpuList(readLine(sysfs_node + "/node" + std::to_string(node) + "/cpulist"));
+    // Memory-only nodes have no CPUs to run on
+    if (!cpus.empty())
+      nodes.push_back(cpus);
+  }
+  return nodes;
+}
+
+std::vector<int> numaMemoryNodes()
+{
+  return parseCpuList(readLine(sysfs_node + "/has_memory"));
+}
+
+int cpuNumaNode(int cpu)
+{
+  for (int node : parseCpuList(readLine(sysfs_node + "/online")))
+    for (int other : parseCpuList(readLine(sysfs_node + "/node" + std::to_string(node) + "/cpulist")))
+      if (other == cpu)
+        return node;
+  return -1;
+}
+
+std::vector<CpuPlace> cpuPlaces()
+{
+  std::map<int, int> nodes;
+  for (int node : parseCpuList(readLine(sysfs_node + "/online")))
+    for (int cpu : parseCpuList(readLine(sysfs_node + "/node" + std::to_string(node) + "/cpulist")))
+      nodes[cpu] = node;
+
+  // Cores and L3 domains are told apart by the list of CPUs they share
+  std::map<std::string, int> cores, l3s;
+  std::vector<CpuPlace> places;
+  for (int cpu : onlineCpus())
+  {
+    const std::string dir = sysfs_cpu + "/cpu" + std::to_string(cpu);
+    CpuPlace place;
+    place.cpu = cpu;
+    place.node = nodes.count(cpu) ? nodes[cpu] : -1;
+
+    std::string siblings = readLine(dir + "/topology/thread_siblings_list");
+    if (siblings.empty())
+      siblings = std::to_string(cpu);
+    const std::vector<int> threads = parseCpuList(siblings);
+    place.core = cores.emplace(siblings, (int)cores.size()).first->second;
+    const std::vector<int>::const_iterator thread = std::find(threads.begin(), threads.end(), cpu);
+    place.thread = thread == threads.end() ? 0 : (int)(thread - threads.begin());
+
+    place.l3 = -1;
+    for (int index = 0; ; index++)
+    {
+      const std::string cache = dir + "/cache/index" + std::to_string(index);
+      const std::string level = readLine(cache + "/level");
+      if (level.empty())
+        break;
+      if (std::atoi(level.c_str()) == 3)
+      {
+        place.l3 = l3s.emplace(readLine(cache + "/shared_cpu_list"), (int)l3s.size()).first->second;
+        break;
+      }
+    }
+    places.push_back(place);
+  }
+  return places;
+}
+
+std::vector<CacheLevel> detectCacheLevels()
+{
+  std::vector<CacheLevel> levels;
+  std::vector<int> cpus = onlineCpus();
+  if (cpus.empty())
+    return levels;
+
+  for (int index = 0; ; index++)
+  {
+    const std::string dir = sysfs_cpu + "/cpu" + std::to_string(cpus.front()) + "/cache/index" + std::to_string(index);
+    const std::string level = readLine(dir + "/level");
+    if (level.empty())
+      break;
+    if (readLine(dir + "/type") == "Instruction")
+      continue;
+
+    // Each distinct set of CPUs sharing this cache index is one instance of the cache
+    std::set<std::string> shared;
+    for (int cpu : cpus)
+    {
+      std::string list = readLine(sysfs_cpu + "/cpu" + std::to_string(cpu) + "/cache/index" + std::to_string(index) + "/shared_cpu_list");
+      if (!list.empty())
+        shared.insert(list);
+    }
+
+    CacheLevel cache;
+    cache.level = std::atoi(level.c_str());
+    cache.size = parseSize(readLine(dir + "/size"));
+    cache.instances = std::max<size_t>(shared.size(), 1);
+    if (cache.size > 0)
+      levels.push_back(cache);
+  }
+
+  std::sort(levels.begin(), levels.end(), [](const CacheLevel& x, const CacheLevel& y){ return x.level < y.level; });
+  return levels;
+}
+
+size_t cacheLineSize()
+{
+  std::vector<int> cpus = onlineCpus();
+  if (cpus.empty())
+    return 0;
+  return std::strtoull(readLine(sysfs_cpu + "/cpu" + std::to_string(cpus.front()) + "/cache/index0/coherency_line_size").c_str(), nullptr, 10);
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Host topology as reported by Linux sysfs (/sys/devices/system/{cpu,node}).
+// On other platforms, or if sysfs is unavailable, all queries return empty results.
+
+struct CacheLevel
+{
+  int level;          // 1, 2, 3, ...
+  size_t size;        // Bytes per cache instance
+  size_t instances;   // Number of distinct instances across all online CPUs
+};
+
+// Where a CPU sits on the host. Cores and L3 domains are numbered 0, 1, ... in order of
+// their lowest CPU.
+struct CpuPlace
+{
+  int cpu;
+  int core;     // Core the CPU is a hardware thread of
+  int thread;   // Index of the CPU among the hardware threads of its core
+  int node;     // NUMA node, -1 if unknown
+  int l3;       // CPUs sharing one L3 cache, -1 without one
+};
+
+// Parse a Linux CPU list such as "0-3,8,10-11"; returns an empty list on malformed input
+std::vector<int> parseCpuList(const std::string& list);
+
+// Format CPUs as a Linux CPU list, the inverse of parseCpuList
+std::string formatCpuList(std::vector<int> cpus);
+
+// Online CPUs
+std::vector<int> onlineCpus();
+
+// CPUs of each online NUMA node, indexed by position in the list of online nodes
+std::vector<std::vector<int>> numaNodeCpus();
+
+// Online NUMA nodes with memory, by node number
+std::vector<int> numaMemoryNodes();
+
+// NUMA node of a CPU, -1 if unknown
+int cpuNumaNode(int cpu);
+
+// Place of each online CPU, ordered by CPU
+std::vector<CpuPlace> cpuPlaces();
+
+// Data and unified caches of the host, ordered by level
+std::vector<CacheLevel> detectCacheLevels();
+
+// Coherency line size of the first data cache in bytes, 0 if unknown
+size_t cacheLineSize();
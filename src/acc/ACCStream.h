@@ -28,7 +28,7 @@ class ACCStream : public Stream<T>
 
   protected:
     // Size of arrays
-    int array_size;
+    intptr_t array_size;
     A aa;
     // Device side pointers
     T *a;
@@ -36,7 +36,7 @@ class ACCStream : public Stream<T>
     T *c;
 
   public:
-    ACCStream(const int, int);
+    ACCStream(const intptr_t, int);
     ~ACCStream();
 
     virtual void copy() override;
@@ -144,6 +144,28 @@ build_gcc() {
     # sanity check that it at least runs
     echo "Sanity checking GCC omp build..."
     "./$BUILD_DIR/omp_$name/omp-stream" -s 1048576 -n 10
+    # indices past 2^31 on sparse arrays, touching only a few pages
+    "./$BUILD_DIR/omp_$name/omp-stream" --check-indices --float
+    # validation must fail on zeroed arrays, also where 100 epsilon of a 16-bit type exceeds the values
+    "./$BUILD_DIR/omp_$name/omp-stream" -s 1048576 -n 10 --type bf16 --corrupt 2>&1 | grep "Validation failed on a\[\]"
+    if [ "${LARGE_MEM_TEST:-false}" != "false" ]; then
+      # more than 2^31 elements per array (~24 GiB in total) to exercise 64-bit sizes and indices
+      echo "Checking GCC omp build with 2^31 + 1024 elements..."
+      "./$BUILD_DIR/omp_$name/omp-stream" -s 2147484672 -n 2 --float
+    fi
+  fi
+
+  run_build $name "${GCC_CXX:?}" simd "$cxx"
+  if [ "$MODEL" = "all" ] || [ "$MODEL" = "simd" ]; then
+    echo "Sanity checking GCC simd build..."
+    "./$BUILD_DIR/simd_$name/simd-stream" -s 1048576 -n 10
+    "./$BUILD_DIR/simd_$name/simd-stream" -s 1048573 -n 10 --float # odd size for the masked tail
+  fi
+
+  run_build $name "${GCC_CXX:?}" threads "$cxx"
+  if [ "$MODEL" = "all" ] || [ "$MODEL" = "threads" ]; then
+    echo "Sanity checking GCC threads build..."
+    "./$BUILD_DIR/threads_$name/threads-stream" -s 1048576 -n 10 --type all
   fi
 
   for use_onedpl in OFF OPENMP TBB; do
@@ -221,6 +243,18 @@ build_clang() {
   local name="clang_build"
   local cxx="-DCMAKE_CXX_COMPILER=${CLANG_CXX:?}"
   run_build $name "${CLANG_CXX:?}" omp "$cxx"
+  run_build $name "${CLANG_CXX:?}" simd "$cxx"
+  if [ "$MODEL" = "all" ] || [ "$MODEL" = "simd" ]; then
+    echo "Sanity checking Clang simd build..."
+    "./$BUILD_DIR/simd_$name/simd-stream" -s 1048576 -n 10
+    "./$BUILD_DIR/simd_$name/simd-stream" -s 1048573 -n 10 --float # odd size for the masked tail
+  fi
+
+  run_build $name "${CLANG_CXX:?}" threads "$cxx"
+  if [ "$MODEL" = "all" ] || [ "$MODEL" = "threads" ]; then
+    echo "Sanity checking Clang threads build..."
+    "./$BUILD_DIR/threads_$name/threads-stream" -s 1048576 -n 10 --type all
+  fi
 
   if [ "${CLANG_OMP_OFFLOAD_AMD:-false}" != "false" ]; then
     run_build "amd_$name" "${GCC_CXX:?}" omp "$cxx -DOFFLOAD=AMD:$AMD_ARCH"
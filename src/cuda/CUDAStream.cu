@@ -19,7 +19,7 @@ void check_error(void)
 }
 
 template <class T>
-CUDAStream<T>::CUDAStream(const int ARRAY_SIZE, const int device_index)
+CUDAStream<T>::CUDAStream(const intptr_t ARRAY_SIZE, const int device_index)
 {
 
   // The array size must be divisible by TBSIZE for kernel launches
@@ -128,7 +128,7 @@ CUDAStream<T>::~CUDAStream()
 template <typename T>
 __global__ void init_kernel(T * a, T * b, T * c, T initA, T initB, T initC)
 {
-  const int i = blockDim.x * blockIdx.x + threadIdx.x;
+  const size_t i = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
   a[i] = initA;
   b[i] = initB;
   c[i] = initC;
@@ -149,7 +149,7 @@ void CUDAStream<T>::read_arrays(std::vector<T>& a, std::vector<T>& b, std::vecto
   // Copy device memory to host
 #if defined(PAGEFAULT) || defined(MANAGED)
   cudaDeviceSynchronize();
-  for (int i = 0; i < array_size; i++)
+  for (intptr_t i = 0; i < array_size; i++)
   {
     a[i] = d_a[i];
     b[i] = d_b[i];
@@ -169,7 +169,7 @@ void CUDAStream<T>::read_arrays(std::vector<T>& a, std::vector<T>& b, std::vecto
 template <typename T>
 __global__ void copy_kernel(const T * a, T * c)
 {
-  const int i = blockDim.x * blockIdx.x + threadIdx.x;
+  const size_t i = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
   c[i] = a[i];
 }
 
@@ -186,7 +186,7 @@ template <typename T>
 __global__ void mul_kernel(T * b, const T * c)
 {
   const T scalar = startScalar;
-  const int i = blockDim.x * blockIdx.x + threadIdx.x;
+  const size_t i = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
   b[i] = scalar * c[i];
 }
 
@@ -202,7 +202,7 @@ void CUDAStream<T>::mul()
 template <typename T>
 __global__ void add_kernel(const T * a, const T * b, T * c)
 {
-  const int i = blockDim.x * blockIdx.x + threadIdx.x;
+  const size_t i = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
   c[i] = a[i] + b[i];
 }
 
@@ -219,7 +219,7 @@ template <typename T>
 __global__ void triad_kernel(T * a, const T * b, const T * c)
 {
   const T scalar = startScalar;
-  const int i = blockDim.x * blockIdx.x + threadIdx.x;
+  const size_t i = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
   a[i] = b[i] + scalar * c[i];
 }
 
@@ -236,7 +236,7 @@ template <typename T>
 __global__ void nstream_kernel(T * a, const T * b, const T * c)
 {
   const T scalar = startScalar;
-  const int i = blockDim.x * blockIdx.x + threadIdx.x;
+  const size_t i = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
   a[i] += b[i] + scalar * c[i];
 }
 
@@ -250,11 +250,11 @@ void CUDAStream<T>::nstream()
 }
 
 template <class T>
-__global__ void dot_kernel(const T * a, const T * b, T * sum, int array_size)
+__global__ void dot_kernel(const T * a, const T * b, T * sum, intptr_t array_size)
 {
   __shared__ T tb_sum[TBSIZE];
 
-  int i = blockDim.x * blockIdx.x + threadIdx.x;
+  size_t i = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
   const size_t local_i = threadIdx.x;
 
   tb_sum[local_i] = {};
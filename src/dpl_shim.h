@@ -2,10 +2,10 @@
 
 #include <cstdlib>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
-#ifndef ALIGNMENT
-#define ALIGNMENT (2*1024*1024) // 2MB
-#endif
+#include "PageAllocator.h"
 
 #ifdef USE_ONEDPL
 
@@ -34,6 +34,7 @@ void dealloc_raw(T *ptr) { sycl::free(ptr, exe_policy.queue()); }
 // auto exe_policy = dpl::execution::seq;
 // auto exe_policy = dpl::execution::par;
 static constexpr auto exe_policy = dpl::execution::par_unseq;
+static constexpr auto block_policy = dpl::execution::unseq;
 #define USE_STD_PTR_ALLOC_DEALLOC
 
 #endif
@@ -49,11 +50,149 @@ static constexpr auto exe_policy = dpl::execution::par_unseq;
 // auto exe_policy = std::execution::seq;
 // auto exe_policy = std::execution::par;
 static constexpr auto exe_policy = std::execution::par_unseq;
+// Policy of each block of a repeated sweep, see sweep_blocks; unseq needs C++20
+static constexpr auto block_policy = std::execution::seq;
 #define USE_STD_PTR_ALLOC_DEALLOC
 
 
 #endif
 
+// Limit the number of threads used by exe_policy from now on, and pin thread i of the
+// backend to cpus[i % cpus.size()].
+// Return false if the parallel backend cannot be limited or pinned at runtime.
+// policy_threads() is the number of threads exe_policy runs on.
+#if defined(_PSTL_PAR_BACKEND_TBB) || (defined(ONEDPL_USE_TBB_BACKEND) && ONEDPL_USE_TBB_BACKEND)
+
+#include <memory>
+#include <tbb/global_control.h>
+#include "TBBAffinity.h"
+
+inline bool set_policy_threads(int n)
+{
+  // TBB honours the most restrictive control alive, so replace rather than add one
+  static std::unique_ptr<tbb::global_control> control;
+  control.reset();
+  control.reset(new tbb::global_control(tbb::global_control::max_allowed_parallelism, n));
+  return true;
+}
+
+inline int policy_threads()
+{
+  return (int)tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism);
+}
+
+inline bool set_policy_affinity(const std::vector<int>& cpus)
+{
+  static std::unique_ptr<TBBPinObserver> pinning;
+  pinning.reset();
+  pinning.reset(new TBBPinObserver(cpus));
+  return true;
+}
+
+#elif defined(_OPENMP) && !(defined(ONEDPL_USE_DPCPP_BACKEND) && ONEDPL_USE_DPCPP_BACKEND)
+
+#include <omp.h>
+
+#include "Affinity.h"
+
+// CPU of each thread, see set_policy_affinity
+inline std::vector<int>& policy_binding()
+{
+  static std::vector<int> cpus;
+  return cpus;
+}
+
+inline bool set_policy_threads(int n)
+{
+  omp_set_num_threads(n);
+  return policy_binding().empty() || pinOpenMPThreads(policy_binding());
+}
+
+inline bool set_policy_affinity(const std::vector<int>& cpus)
+{
+  policy_binding() = cpus;
+  return pinOpenMPThreads(cpus);
+}
+
+inline int policy_threads() { return omp_get_max_threads(); }
+
+#else
+
+#include <thread>
+
+inline bool set_policy_threads(int) { return false; }
+inline bool set_policy_affinity(const std::vector<int>&) { return false; }
+inline int policy_threads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+#endif
+
+// Run kernel(policy, begin, end) over [0, n): once with exe_policy or, for reps > 1, reps
+// times over each of one block per thread of exe_policy, with block_policy on the thread
+// the block landed on. The Parallel STL has no parallel region to stay in, so each block
+// repeats on its own, see Stream<T>::set_inner_reps. policy_repeats() is false where the
+// kernels run on a device and cannot be split by host threads.
+#if defined(ONEDPL_USE_DPCPP_BACKEND) && ONEDPL_USE_DPCPP_BACKEND
+
+constexpr bool policy_repeats() { return false; }
+template <class F>
+void sweep_blocks(intptr_t n, unsigned int, const F& kernel) { kernel(exe_policy, 0, n); }
+
+template <class T, class F>
+T sweep_blocks_reduce(intptr_t n, unsigned int, const F& kernel) { return kernel(exe_policy, 0, n); }
+
+#else
+
+constexpr bool policy_repeats() { return true; }
+template <class F>
+void sweep_blocks(intptr_t n, unsigned int reps, const F& kernel)
+{
+  if (reps == 1)
+  {
+    kernel(exe_policy, 0, n);
+    return;
+  }
+  std::vector<intptr_t> blocks(policy_threads());
+  for (size_t k = 0; k < blocks.size(); k++)
+    blocks[k] = k;
+  const intptr_t count = blocks.size();
+  std::for_each(exe_policy, blocks.begin(), blocks.end(), [&](intptr_t k) {
+    for (unsigned int rep = 0; rep < reps; rep++)
+      kernel(block_policy, n * k / count, n * (k + 1) / count);
+  });
+}
+
+// As sweep_blocks, for kernels returning a sum over one sweep
+template <class T, class F>
+T sweep_blocks_reduce(intptr_t n, unsigned int reps, const F& kernel)
+{
+  if (reps == 1)
+    return kernel(exe_policy, 0, n);
+  std::vector<intptr_t> blocks(policy_threads());
+  for (size_t k = 0; k < blocks.size(); k++)
+    blocks[k] = k;
+  const intptr_t count = blocks.size();
+  return std::transform_reduce(exe_policy, blocks.begin(), blocks.end(), T{}, std::plus<T>(), [&](intptr_t k) {
+    T sum{};
+    for (unsigned int rep = 0; rep < reps; rep++)
+      sum += kernel(block_policy, n * k / count, n * (k + 1) / count);
+    return sum;
+  }) / T(reps);
+}
+
+#endif
+
+// Copy the first n elements of an array to a host vector, for read_arrays: in parallel
+// with exe_policy where it runs on the host
+template <class T>
+void copy_to_host(const T *array, intptr_t n, std::vector<T>& host)
+{
+#if defined(ONEDPL_USE_DPCPP_BACKEND) && ONEDPL_USE_DPCPP_BACKEND
+  std::copy(array, array + n, host.begin());
+#else
+  std::copy(exe_policy, array, array + n, host.begin());
+#endif
+}
+
 #ifdef USE_STD_PTR_ALLOC_DEALLOC
 
 #if defined(__HIPSYCL__) || defined(__OPENSYCL__)
@@ -67,10 +206,10 @@ template <typename T> void dealloc_raw(T *ptr) { cl::sycl::free(ptr, queue); }
 
 #else
 template<typename T>
-T *alloc_raw(size_t size) { return (T *) aligned_alloc(ALIGNMENT, sizeof(T) * size); }
+T *alloc_raw(size_t size) { return allocArray<T>(size); }
 
 template<typename T>
-void dealloc_raw(T *ptr) { free(ptr); }
+void dealloc_raw(T *ptr) { freePages(ptr); }
 #endif
 
 #endif
@@ -11,7 +11,7 @@
 #include "FutharkStream.h"
 
 template <class T>
-FutharkStream<T>::FutharkStream(const int ARRAY_SIZE, int device)
+FutharkStream<T>::FutharkStream(const intptr_t ARRAY_SIZE, int device)
 {
   this->array_size = ARRAY_SIZE;
   this->cfg = futhark_context_config_new();
@@ -59,11 +59,11 @@ FutharkStream<double>::~FutharkStream()
 
 template <>
 void FutharkStream<float>::init_arrays(float initA, float initB, float initC) {
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   float *a = new float[array_size];
   float *b = new float[array_size];
   float *c = new float[array_size];
-  for (int i = 0; i < array_size; i++) {
+  for (intptr_t i = 0; i < array_size; i++) {
     a[i] = initA;
     b[i] = initB;
     c[i] = initC;
@@ -79,11 +79,11 @@ void FutharkStream<float>::init_arrays(float initA, float initB, float initC) {
 
 template <>
 void FutharkStream<double>::init_arrays(double initA, double initB, double initC) {
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   double *a = new double[array_size];
   double *b = new double[array_size];
   double *c = new double[array_size];
-  for (int i = 0; i < array_size; i++) {
+  for (intptr_t i = 0; i < array_size; i++) {
     a[i] = initA;
     b[i] = initB;
     c[i] = initC;
@@ -31,7 +31,7 @@ class FutharkStream : public Stream<T>
 {
 protected:
   // Size of arrays
-  int array_size;
+  intptr_t array_size;
   // For device selection.
   std::string device;
 
@@ -45,7 +45,7 @@ protected:
   void* c;
 
 public:
-  FutharkStream(const int, int);
+  FutharkStream(const intptr_t, int);
   ~FutharkStream();
 
   virtual void copy() override;
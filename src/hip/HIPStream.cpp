@@ -22,7 +22,7 @@ void check_error(void)
 }
 
 template <class T>
-HIPStream<T>::HIPStream(const int ARRAY_SIZE, const int device_index)
+HIPStream<T>::HIPStream(const intptr_t ARRAY_SIZE, const int device_index)
 {
 
   // The array size must be divisible by TBSIZE for kernel launches
@@ -117,7 +117,7 @@ HIPStream<T>::~HIPStream()
 template <typename T>
 __global__ void init_kernel(T * a, T * b, T * c, T initA, T initB, T initC)
 {
-  const size_t i = blockDim.x * blockIdx.x + threadIdx.x;
+  const size_t i = (size_t)blockDim.x * blockIdx.x + threadIdx.x;
   a[i] = initA;
   b[i] = initB;
   c[i] = initC;
@@ -139,7 +139,7 @@ void HIPStream<T>::read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector
   // Copy device memory to host
 #if defined(PAGEFAULT) || defined(MANAGED)
     hipDeviceSynchronize();
-  for (int i = 0; i < array_size; i++)
+  for (intptr_t i = 0; i < array_size; i++)
   {
     a[i] = d_a[i];
     b[i] = d_b[i];
@@ -158,7 +158,7 @@ void HIPStream<T>::read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector
 template <typename T>
 __global__ void copy_kernel(const T * a, T * c)
 {
-  const size_t i = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t i = threadIdx.x + (size_t)blockIdx.x * blockDim.x;
   c[i] = a[i];
 }
 
@@ -175,7 +175,7 @@ template <typename T>
 __global__ void mul_kernel(T * b, const T * c)
 {
   const T scalar = startScalar;
-  const size_t i = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t i = threadIdx.x + (size_t)blockIdx.x * blockDim.x;
   b[i] = scalar * c[i];
 }
 
@@ -191,7 +191,7 @@ void HIPStream<T>::mul()
 template <typename T>
 __global__ void add_kernel(const T * a, const T * b, T * c)
 {
-  const size_t i = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t i = threadIdx.x + (size_t)blockIdx.x * blockDim.x;
   c[i] = a[i] + b[i];
 }
 
@@ -208,7 +208,7 @@ template <typename T>
 __global__ void triad_kernel(T * a, const T * b, const T * c)
 {
   const T scalar = startScalar;
-  const size_t i = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t i = threadIdx.x + (size_t)blockIdx.x * blockDim.x;
   a[i] = b[i] + scalar * c[i];
 }
 
@@ -225,7 +225,7 @@ template <typename T>
 __global__ void nstream_kernel(T * a, const T * b, const T * c)
 {
   const T scalar = startScalar;
-  const size_t i = threadIdx.x + blockIdx.x * blockDim.x;
+  const size_t i = threadIdx.x + (size_t)blockIdx.x * blockDim.x;
   a[i] += b[i] + scalar * c[i];
 }
 
@@ -239,12 +239,12 @@ void HIPStream<T>::nstream()
 }
 
 template <typename T>
-__global__ void dot_kernel(const T * a, const T * b, T * sum, int array_size)
+__global__ void dot_kernel(const T * a, const T * b, T * sum, intptr_t array_size)
 {
   __shared__ T tb_sum[TBSIZE];
 
   const size_t local_i = threadIdx.x;
-  size_t i = blockDim.x * blockIdx.x + local_i;
+  size_t i = (size_t)blockDim.x * blockIdx.x + local_i;
 
   tb_sum[local_i] = {};
   for (; i < array_size; i += blockDim.x*gridDim.x)
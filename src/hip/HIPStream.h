@@ -37,7 +37,7 @@ class HIPStream : public Stream<T>
 
   protected:
     // Size of arrays
-    int array_size;
+    intptr_t array_size;
     int dot_num_blocks;
 
     // Host array for partial sums for dot kernel
@@ -51,7 +51,7 @@ class HIPStream : public Stream<T>
 
   public:
 
-    HIPStream(const int, const int);
+    HIPStream(const intptr_t, const int);
     ~HIPStream();
 
     virtual void copy() override;
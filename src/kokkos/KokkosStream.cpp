@@ -9,8 +9,8 @@
 
 template <class T>
 KokkosStream<T>::KokkosStream(
-        const int ARRAY_SIZE, const int device_index)
-    : array_size(ARRAY_SIZE)
+        const intptr_t ARRAY_SIZE, const int device_index)
+    : array_size(ARRAY_SIZE), inner_reps(1)
 {
   Kokkos::initialize();
 
@@ -53,12 +53,103 @@ void KokkosStream<T>::read_arrays(
   deep_copy(*hm_a, *d_a);
   deep_copy(*hm_b, *d_b);
   deep_copy(*hm_c, *d_c);
-  for(int ii = 0; ii < array_size; ++ii)
+  typename Kokkos::View<T*>::HostMirror h_a(*hm_a);
+  typename Kokkos::View<T*>::HostMirror h_b(*hm_b);
+  typename Kokkos::View<T*>::HostMirror h_c(*hm_c);
+  Kokkos::parallel_for(Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, array_size), [&](const long ii)
   {
-    a[ii] = (*hm_a)(ii);
-    b[ii] = (*hm_b)(ii);
-    c[ii] = (*hm_c)(ii);
+    a[ii] = h_a(ii);
+    b[ii] = h_b(ii);
+    c[ii] = h_c(ii);
+  });
+  Kokkos::fence();
+}
+
+// Mean absolute error of one array, computed where its elements are
+template <class T>
+double mean_error(const Kokkos::View<T*>& x, const T gold, const long n)
+{
+  double sum = 0.0;
+  Kokkos::parallel_reduce(n, KOKKOS_LAMBDA (const long index, double &tmp)
+  {
+    const T diff = x[index] - gold;
+    tmp += diff < 0 ? -diff : diff;
+  }, sum);
+  return sum / n;
+}
+
+template <class T>
+bool KokkosStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  errA = mean_error(*d_a, goldA, array_size);
+  errB = mean_error(*d_b, goldB, array_size);
+  errC = mean_error(*d_c, goldC, array_size);
+  return true;
+}
+
+template <class T>
+bool KokkosStream<T>::set_array_size(intptr_t n)
+{
+  array_size = n;
+  return true;
+}
+
+template <class T>
+bool KokkosStream<T>::set_inner_reps(unsigned int reps)
+{
+  // Blocks of the arrays are swept by host threads, not device ones
+  if (reps > 1 && !Kokkos::SpaceAccessibility<Kokkos::HostSpace, Kokkos::DefaultExecutionSpace::memory_space>::accessible)
+    return false;
+  inner_reps = reps;
+  return true;
+}
+
+// Run body(index) over the arrays: once in one parallel_for or, with inner repetition,
+// inner_reps times over each of one block per thread of the execution space. A static
+// schedule gives each thread the same block on every call.
+template <class T>
+template <class F>
+void KokkosStream<T>::sweep(const F& body)
+{
+  if (inner_reps == 1)
+  {
+    Kokkos::parallel_for(array_size, body);
+  }
+  else
+  {
+    const long n = array_size, blocks = Kokkos::DefaultExecutionSpace().concurrency();
+    const unsigned int reps = inner_reps;
+    Kokkos::parallel_for(Kokkos::RangePolicy<Kokkos::Schedule<Kokkos::Static>>(0, blocks), KOKKOS_LAMBDA (const long block)
+    {
+      for (unsigned int rep = 0; rep < reps; rep++)
+        for (long index = n * block / blocks; index < n * (block + 1) / blocks; index++)
+          body(index);
+    });
+  }
+  Kokkos::fence();
+}
+
+// As sweep, for body(index, tmp) adding to tmp, returning the sum over one sweep
+template <class T>
+template <class F>
+T KokkosStream<T>::sweep_reduce(const F& body)
+{
+  T sum{};
+  if (inner_reps == 1)
+  {
+    Kokkos::parallel_reduce(array_size, body, sum);
+    return sum;
   }
+
+  const long n = array_size, blocks = Kokkos::DefaultExecutionSpace().concurrency();
+  const unsigned int reps = inner_reps;
+  Kokkos::parallel_reduce(Kokkos::RangePolicy<Kokkos::Schedule<Kokkos::Static>>(0, blocks), KOKKOS_LAMBDA (const long block, T &tmp)
+  {
+    for (unsigned int rep = 0; rep < reps; rep++)
+      for (long index = n * block / blocks; index < n * (block + 1) / blocks; index++)
+        body(index, tmp);
+  }, sum);
+  return sum / T(reps);
 }
 
 template <class T>
@@ -68,11 +159,10 @@ void KokkosStream<T>::copy()
   Kokkos::View<T*> b(*d_b);
   Kokkos::View<T*> c(*d_c);
 
-  Kokkos::parallel_for(array_size, KOKKOS_LAMBDA (const long index)
+  sweep(KOKKOS_LAMBDA (const long index)
   {
     c[index] = a[index];
   });
-  Kokkos::fence();
 }
 
 template <class T>
@@ -83,11 +173,10 @@ void KokkosStream<T>::mul()
   Kokkos::View<T*> c(*d_c);
 
   const T scalar = startScalar;
-  Kokkos::parallel_for(array_size, KOKKOS_LAMBDA (const long index)
+  sweep(KOKKOS_LAMBDA (const long index)
   {
     b[index] = scalar*c[index];
   });
-  Kokkos::fence();
 }
 
 template <class T>
@@ -97,11 +186,10 @@ void KokkosStream<T>::add()
   Kokkos::View<T*> b(*d_b);
   Kokkos::View<T*> c(*d_c);
 
-  Kokkos::parallel_for(array_size, KOKKOS_LAMBDA (const long index)
+  sweep(KOKKOS_LAMBDA (const long index)
   {
     c[index] = a[index] + b[index];
   });
-  Kokkos::fence();
 }
 
 template <class T>
@@ -112,10 +200,31 @@ void KokkosStream<T>::triad()
   Kokkos::View<T*> c(*d_c);
 
   const T scalar = startScalar;
-  Kokkos::parallel_for(array_size, KOKKOS_LAMBDA (const long index)
+  sweep(KOKKOS_LAMBDA (const long index)
   {
     a[index] = b[index] + scalar*c[index];
   });
+}
+
+template <class T>
+bool KokkosStream<T>::roofline(unsigned int fmas)
+{
+  ROOFLINE_DISPATCH(fmas, roofline_kernel)
+}
+
+template <class T>
+template <unsigned int K>
+void KokkosStream<T>::roofline_kernel()
+{
+  Kokkos::View<T*> a(*d_a);
+  Kokkos::View<T*> b(*d_b);
+  Kokkos::View<T*> c(*d_c);
+
+  const T scalar = startScalar;
+  Kokkos::parallel_for(array_size, KOKKOS_LAMBDA (const long index)
+  {
+    a[index] = RooflineChain<K>::apply(b[index] + scalar*c[index], c[index], scalar);
+  });
   Kokkos::fence();
 }
 
@@ -127,11 +236,10 @@ void KokkosStream<T>::nstream()
   Kokkos::View<T*> c(*d_c);
 
   const T scalar = startScalar;
-  Kokkos::parallel_for(array_size, KOKKOS_LAMBDA (const long index)
+  sweep(KOKKOS_LAMBDA (const long index)
   {
     a[index] += b[index] + scalar*c[index];
   });
-  Kokkos::fence();
 }
 
 template <class T>
@@ -140,14 +248,10 @@ T KokkosStream<T>::dot()
   Kokkos::View<T*> a(*d_a);
   Kokkos::View<T*> b(*d_b);
 
-  T sum{};
-
-  Kokkos::parallel_reduce(array_size, KOKKOS_LAMBDA (const long index, T &tmp)
+  return sweep_reduce(KOKKOS_LAMBDA (const long index, T &tmp)
   {
     tmp += a[index] * b[index];
-  }, sum);
-
-  return sum;
+  });
 
 }
 
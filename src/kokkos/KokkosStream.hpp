@@ -11,6 +11,7 @@
 
 #include <Kokkos_Core.hpp>
 #include "Stream.h"
+#include "Roofline.h"
 
 #define IMPLEMENTATION_STRING "Kokkos"
 
@@ -19,7 +20,7 @@ class KokkosStream : public Stream<T>
 {
   protected:
     // Size of arrays
-    int array_size;
+    intptr_t array_size;
 
     // Device side pointers to arrays
      typename Kokkos::View<T*>* d_a;
@@ -29,9 +30,17 @@ class KokkosStream : public Stream<T>
      typename Kokkos::View<T*>::HostMirror* hm_b;
      typename Kokkos::View<T*>::HostMirror* hm_c;
 
+    // Sweeps of the main kernels per call, see set_inner_reps
+    unsigned int inner_reps;
+
+    template <class F>
+    void sweep(const F& body);
+    template <class F>
+    T sweep_reduce(const F& body);
+
   public:
 
-    KokkosStream(const int, const int);
+    KokkosStream(const intptr_t, const int);
     ~KokkosStream();
 
     virtual void copy() override;
@@ -44,5 +53,12 @@ class KokkosStream : public Stream<T>
     virtual void init_arrays(T initA, T initB, T initC) override;
     virtual void read_arrays(
             std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool set_inner_reps(unsigned int reps) override;
+    virtual bool roofline(unsigned int fmas) override;
+
+    template <unsigned int K>
+    void roofline_kernel();
 };
 
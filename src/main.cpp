@@ -15,61 +15,194 @@
 #include <algorithm>
 #include <iomanip>
 #include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <functional>
+#include <map>
+#include <set>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef BABELSTREAM_MPI
+#include <mpi.h>
+#endif
 
 #define VERSION_STRING "5.0"
 
 #include "Stream.h"
-
-#if defined(CUDA)
-#include "CUDAStream.h"
-#elif defined(STD_DATA)
-#include "STDDataStream.h"
-#elif defined(STD_INDICES)
-#include "STDIndicesStream.h"
-#elif defined(STD_RANGES)
-#include "STDRangesStream.hpp"
-#elif defined(TBB)
-#include "TBBStream.hpp"
-#elif defined(THRUST)
-#include "ThrustStream.h"
-#elif defined(HIP)
-#include "HIPStream.h"
-#elif defined(HC)
-#include "HCStream.h"
-#elif defined(OCL)
-#include "OCLStream.h"
-#elif defined(USE_RAJA)
-#include "RAJAStream.hpp"
-#elif defined(KOKKOS)
-#include "KokkosStream.hpp"
-#elif defined(ACC)
-#include "ACCStream.h"
-#elif defined(SYCL)
-#include "SYCLStream.h"
-#elif defined(SYCL2020)
-#include "SYCLStream2020.h"
-#elif defined(OMP)
-#include "OMPStream.h"
-#elif defined(FUTHARK)
-#include "FutharkStream.h"
+#include "Topology.h"
+#include "Statistics.h"
+#include "JsonReport.h"
+#include "ProcessGroup.h"
+#include "PerfCounters.h"
+#include "Roofline.h"
+#include "MixKernels.h"
+#include "IndexPatterns.h"
+#include "PointerChase.h"
+#include "PageAllocator.h"
+#include "Affinity.h"
+#include "ResultTable.h"
+
+#ifdef BABELSTREAM_PLUGINS
+#include "StreamPlugin.h"
+#else
+#include "StreamModels.h"
 #endif
 
+
 // Default size of 2^25
-int ARRAY_SIZE = 33554432;
+intptr_t ARRAY_SIZE = 33554432;
+
+// Arrays may hold more than 2^31 - 1 elements; --check-indices maps arrays of this many
+// elements without touching most of them, the opt-in LARGE_MEM_TEST run of
+// ci-test-compile.sh runs the kernels on all of them
+const int64_t large_array_size = 2147484672; // 2^31 + 1024
 unsigned int num_times = 100;
 unsigned int num_warmups = 10;
 unsigned int deviceIndex = 0;
-bool use_float = false;
+// Element types to run the kernels on, in order, see --type; --type all skips those the
+// model was not built for rather than failing
+std::vector<ElementType> element_types = {ElementType::F64};
+bool all_types = false;
 bool output_as_csv = false;
 bool mibibytes = false;
 std::string csv_separator = ",";
 std::string csv_filename = "";
 
+// JSON output of per-iteration samples and statistics; NDJSON appends one line per result
+std::string json_filename = "";
+bool json_lines = false;
+
+#ifdef BABELSTREAM_PLUGINS
+// Models to run, in order, and the plugin of the one currently running
+std::vector<std::string> models;
+const StreamPlugin *plugin = nullptr;
+std::string implementation = "";
+#else
+std::string implementation = IMPLEMENTATION_STRING;
+#endif
+bool list_devices = false;
+
+// Adaptive iteration count: stop once every kernel's 95% confidence interval is within
+// +/- adaptive_width of its mean (0 disables), or after time_budget seconds
+double adaptive_width = 0.0;
+double time_budget = 60.0;
+
+// Soak mode: run for soak_duration seconds (0 disables), reporting bandwidth and
+// validating the arrays every soak_window iterations
+double soak_duration = 0.0;
+unsigned int soak_window = 10;
+
+// Thread counts to run in turn (empty disables) and the fraction of the peak bandwidth
+// at which a kernel is considered saturated
+std::vector<int> thread_counts;
+const double saturation = 0.95;
+
+// Multi-process mode: fork num_procs workers (0 disables) that run the kernels in lockstep,
+// each bound to the CPUs of one NUMA node or of one entry of proc_cpus, if requested
+unsigned int num_procs = 0;
+bool proc_bind_numa = false;
+std::vector<std::vector<int>> proc_cpus;
+
+// Placement of the threads of the model, see Affinity.h; binding holds the CPU of each
+// thread, empty unless --bind picks a policy other than none
+bool bind_requested = false;
+BindPolicy bind_policy = BindPolicy::None;
+std::vector<int> bind_list;
+bool bind_smt = false;
+std::vector<int> binding;
+
+// MPI builds: rank of this process and number of ranks, each running the benchmark on its
+// own arrays; only rank 0 writes output
+int mpi_rank = 0;
+int mpi_size = 1;
+
+// Ranks whose best bandwidth for any kernel is below this fraction of the median over all
+// ranks are listed as outliers
+const double outlier_fraction = 0.9;
+
+// Called before every timed kernel to line up benchmarks running concurrently
+std::function<void()> kernel_barrier;
+
+// Roofline mode: run the roofline kernel for every compiled number of extra multiply-adds
+// per element up to roofline_max (negative disables)
+int roofline_max = -1;
+
+// Mix mode: run the kernel reading R arrays and writing W arrays for each R:W pair listed
+std::vector<std::pair<unsigned int, unsigned int>> mix_ratios;
+
+// Strided mode: run copy and triad over every S-th element for S = 1, 2, 4, ... up to
+// strided_pages pages apart (0 disables)
+unsigned int strided_pages = 0;
+
+// Rerun the kernels with non-temporal stores after the regular run; nontemporal_pass
+// is set during the rerun, whose kernels are labelled with an NT suffix
+bool nontemporal = false;
+bool nontemporal_pass = false;
+
+// Indirect mode: run gather and scatter through each index pattern listed
+std::vector<IndexPattern> index_patterns;
+
+// Latency mode: chase lists of 4 KiB, 8 KiB, ... up to latency_bytes per thread (0
+// disables) with 1, 2, 4, ... up to latency_chains independent chains at once
+size_t latency_bytes = 0;
+unsigned int latency_chains = 1;
+
+// Launch mode: time launch_calls single calls of each kernel on empty arrays and on one
+// element per thread (0 disables)
+unsigned int launch_calls = 0;
+
+// Sweeps of the main kernels within each call, see Stream<T>::set_inner_reps; timings
+// are divided by it, so that bandwidth is that of one sweep
+unsigned int inner_reps = 1;
+
+// Check 64-bit sizes and indices on sparse arrays of large_array_size elements
+bool index_check = false;
+
+// Zero the arrays after the benchmark, before they are checked, to test that validation
+// catches it
+bool corrupt_arrays = false;
+
+// Kind of pages behind the arrays of the models that use PageAllocator, and their
+// placement across NUMA nodes
+PageMode page_mode = PageMode::Default;
+NumaPolicy numa_policy = NumaPolicy::Local;
+int numa_node = 0;
+
+// Hardware performance counters read around every kernel, if requested
+bool perf_counters = false;
+PerfCounters *counters = nullptr;
+
+// Array size sweep: runs for each size in the geometric series
+// sweep_min, sweep_min * sweep_factor, ... up to ARRAY_SIZE
+bool sweep = false;
+intptr_t sweep_min = 0;
+double sweep_factor = 2.0;
+
+template <typename T>
+void check_solution(Stream<T> *stream, intptr_t array_size, const unsigned int ntimes, T& sum);
+
 template <typename T>
-void check_solution(const unsigned int ntimes, std::vector<T>& a, std::vector<T>& b, std::vector<T>& c, T& sum);
+void check_solution(intptr_t array_size, const unsigned int ntimes, double errA, double errB, double errC, T& sum);
 
 template <typename T>
-void run();
+void gold_values(const unsigned int ntimes, T& goldA, T& goldB, T& goldC);
+
+// Best bandwidth of each kernel in a run, used to compare models
+typedef std::vector<std::pair<std::string, double>> Results;
+
+template <typename T>
+Results run();
+
+Results run_types();
 
 // Options for running the benchmark:
 // - All 5 kernels (Copy, Add, Mul, Triad, Dot).
@@ -82,139 +215,2170 @@ Benchmark selection = Benchmark::All;
 
 void parseArguments(int argc, char *argv[]);
 
+#ifdef BABELSTREAM_PLUGINS
+void print_comparison(const std::vector<Results>& results);
+#endif
+std::string suffixed_path(const std::string& path, const std::string& suffix);
+
+#ifdef BABELSTREAM_MPI
+void finalize_mpi()
+{
+  int finalized;
+  MPI_Finalized(&finalized);
+  if (!finalized)
+    MPI_Finalize();
+}
+#endif
+
 int main(int argc, char *argv[])
 {
 
+#ifdef BABELSTREAM_MPI
+  MPI_Init(&argc, &argv);
+  std::atexit(finalize_mpi);
+  MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+
+  // Other ranks stay quiet apart from errors
+  if (mpi_rank > 0)
+    std::cout.rdbuf(nullptr);
+  if (mpi_size > 1)
+    kernel_barrier = []() { MPI_Barrier(MPI_COMM_WORLD); };
+#endif
+
   parseArguments(argc, argv);
 
+  if (mpi_rank > 0)
+  {
+    csv_filename = "";
+    json_filename = "";
+  }
+
+  if (bind_policy != BindPolicy::None)
+  {
+    // OMP_NUM_THREADS is honoured by every CPU model, otherwise one thread per CPU
+    const char *env = std::getenv("OMP_NUM_THREADS");
+    binding = bindingCpus(bind_policy, bind_list, bind_smt, env ? std::atoi(env) : 0);
+    if (binding.empty())
+    {
+      std::cerr << "Not all CPUs of the --bind list are available to this process" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+#ifdef BABELSTREAM_PLUGINS
+  if (models.empty())
+  {
+    std::cerr << "No model selected, use --model NAME[,NAME...]. Available models:";
+    for (const std::string& model : findStreamPlugins())
+      std::cerr << " " << model;
+    std::cerr << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (list_devices)
+  {
+    for (const std::string& model : models)
+    {
+      std::cout << model << ":" << std::endl;
+      loadStreamPlugin(model)->list_devices();
+    }
+    exit(EXIT_SUCCESS);
+  }
+
+  std::cout
+    << "BabelStream" << std::endl
+    << "Version: " << VERSION_STRING << std::endl;
+
+  // With several models, each writes to its own csv/json file
+  const std::string csv_path = csv_filename;
+  const std::string json_path = json_filename;
+
+  std::vector<Results> results;
+  for (const std::string& model : models)
+  {
+    plugin = loadStreamPlugin(model);
+    plugin->set_page_mode(page_mode);
+    plugin->set_numa_policy(numa_policy, numa_node);
+    plugin->set_page_reuse(element_types.size() > 1);
+    implementation = plugin->implementation;
+    if (models.size() > 1)
+    {
+      csv_filename = suffixed_path(csv_path, model);
+      json_filename = suffixed_path(json_path, model);
+      std::cout << std::endl;
+    }
+
+    std::cout << "Implementation: " << implementation << std::endl;
+
+    results.push_back(run_types());
+    plugin->set_page_reuse(false);
+  }
+
+  if (models.size() > 1)
+    print_comparison(results);
+#else
+  if (list_devices)
+  {
+    listDevices();
+    exit(EXIT_SUCCESS);
+  }
+
+  setPageMode(page_mode);
+  setNumaPolicy(numa_policy, numa_node);
+  setPageReuse(element_types.size() > 1);
+
   std::cout
     << "BabelStream" << std::endl
     << "Version: " << VERSION_STRING << std::endl
-    << "Implementation: " << IMPLEMENTATION_STRING << std::endl;
+    << "Implementation: " << implementation << std::endl;
 
-  if (use_float)
-    run<float>();
-  else
-    run<double>(); 
+  run_types();
+  setPageReuse(false);
+#endif
 
 }
 
+// Factor from bytes per second to the bandwidth unit of the output, MB/s or MiB/s
+double bandwidth_scale()
+{
+  return mibibytes ? std::pow(2.0, -20.0) : 1.0E-6;
+}
 
-// Run the 5 main kernels
+// Heading and CSV name of a bandwidth column, e.g. "MBytes/sec" and "max_mbytes_per_sec"
+std::string bandwidth_heading()
+{
+  return mibibytes ? "MiBytes/sec" : "MBytes/sec";
+}
+
+std::string bandwidth_csv(const std::string& prefix, const std::string& suffix = "")
+{
+  return (prefix.empty() ? "" : prefix + "_") + (mibibytes ? "mibytes_per_sec" : "mbytes_per_sec") + suffix;
+}
+
+// Table of the results of a mode, also written to the CSV file with --csv
+ResultTable result_table(const std::vector<TableColumn>& columns)
+{
+  return ResultTable(columns, output_as_csv ? csv_filename : "", csv_separator);
+}
+
+// Insert a model or type name before the extension of an output path:
+// results.csv -> results-omp.csv
+std::string suffixed_path(const std::string& path, const std::string& suffix)
+{
+  if (path.empty())
+    return path;
+  const size_t slash = path.find_last_of('/');
+  const size_t dot = path.find_last_of('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    return path + "-" + suffix;
+  return path.substr(0, dot) + "-" + suffix + path.substr(dot);
+}
+
+// Run the benchmark on elements of type T if the model was built for it, returns false
+// otherwise
 template <typename T>
-std::vector<std::vector<double>> run_all(Stream<T> *stream, T& sum)
+bool run_type(Results& results, std::true_type)
 {
+#ifdef BABELSTREAM_PLUGINS
+  if (!plugin->make[(int)Element<T>::type])
+    return false;
+#endif
+  results = run<T>();
+  return true;
+}
 
-  // List of times
-  std::vector<std::vector<double>> timings(5);
+template <typename T>
+bool run_type(Results&, std::false_type)
+{
+  return false;
+}
 
-  // Declare timers
-  std::chrono::high_resolution_clock::time_point t1, t2;
+template <typename T>
+bool run_type(Results& results)
+{
+#ifdef BABELSTREAM_PLUGINS
+  return run_type<T>(results, std::true_type());
+#else
+  return run_type<T>(results, ModelHasType<T>());
+#endif
+}
 
-  for (unsigned int k = 0; k < num_times + num_warmups; k++)
+// Run the benchmark for each element type requested. With several, each writes to its
+// own csv/json file and the labels of the results start with the type.
+Results run_types()
+{
+  const std::string csv_path = csv_filename;
+  const std::string json_path = json_filename;
+
+  Results all;
+  for (ElementType type : element_types)
   {
-    // Execute Copy
-    t1 = std::chrono::high_resolution_clock::now();
-    stream->copy();
-    t2 = std::chrono::high_resolution_clock::now();
-    timings[0].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+    const std::string name = elementTypeName(type);
+    if (element_types.size() > 1)
+    {
+      csv_filename = suffixed_path(csv_path, name);
+      json_filename = suffixed_path(json_path, name);
+      std::cout << std::endl;
+    }
+
+    // Each run starts from the same output format
+    const std::ios_base::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    const std::streamsize error_precision = std::cerr.precision();
+    Results results;
+    bool supported = false;
+    switch (type)
+    {
+#ifdef STREAM_HAVE_F16
+      case ElementType::F16: supported = run_type<float16>(results); break;
+#endif
+      case ElementType::BF16: supported = run_type<bfloat16>(results); break;
+      case ElementType::F32: supported = run_type<float>(results); break;
+      case ElementType::F64: supported = run_type<double>(results); break;
+      case ElementType::I32: supported = run_type<int32_t>(results); break;
+      case ElementType::I64: supported = run_type<int64_t>(results); break;
+      case ElementType::C32: supported = run_type<std::complex<float>>(results); break;
+      case ElementType::C64: supported = run_type<std::complex<double>>(results); break;
+      default: break;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+    std::cerr.precision(error_precision);
+    if (!supported)
+    {
+      if (!all_types)
+      {
+        std::cerr << "--type " << name << " is not supported by " << implementation << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      std::cout << "Skipping " << name << ", which " << implementation << " is not built for" << std::endl;
+      continue;
+    }
+
+    for (const std::pair<std::string, double>& result : results)
+      all.push_back(element_types.size() > 1 ? std::make_pair(name + " " + result.first, result.second) : result);
+  }
+
+  csv_filename = csv_path;
+  json_filename = json_path;
+  return all;
+}
 
-    // Execute Mul
-    t1 = std::chrono::high_resolution_clock::now();
-    stream->mul();
-    t2 = std::chrono::high_resolution_clock::now();
-    timings[1].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+#ifdef BABELSTREAM_PLUGINS
+// Construct the implementation of the current plugin with the given array size
+template <typename T>
+Stream<T> *make_stream(intptr_t array_size)
+{
+  return makePluginStream<T>(plugin, array_size, deviceIndex);
+}
 
-    // Execute Add
-    t1 = std::chrono::high_resolution_clock::now();
-    stream->add();
-    t2 = std::chrono::high_resolution_clock::now();
-    timings[2].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+// Print the best bandwidth of each kernel for every model side by side
+void print_comparison(const std::vector<Results>& results)
+{
+  std::streamsize ss = std::cout.precision();
 
-    // Execute Triad
-    t1 = std::chrono::high_resolution_clock::now();
-    stream->triad();
-    t2 = std::chrono::high_resolution_clock::now();
-    timings[3].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+  // Widen the first column for the longer labels of the special modes, e.g. "Gather block:1024"
+  size_t width = 12;
+  for (const std::pair<std::string, double>& result : results.front())
+    width = std::max(width, result.first.size() + 2);
 
-    // Execute Dot
-    t1 = std::chrono::high_resolution_clock::now();
-    sum = stream->dot();
-    t2 = std::chrono::high_resolution_clock::now();
-    timings[4].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+  const std::string unit = launch_calls > 0 ? "median us per call" : bandwidth_heading();
+  std::cout << std::endl << "Comparison (" << unit << ")" << std::endl;
+  std::cout << std::left << std::setw(width) << "Function";
+  for (const std::string& model : models)
+    std::cout << std::left << std::setw(std::max<size_t>(14, model.size() + 2)) << model;
+  std::cout << std::endl << std::fixed;
 
+  for (size_t k = 0; k < results.front().size(); k++)
+  {
+    std::cout << std::left << std::setw(width) << results.front()[k].first;
+    for (size_t m = 0; m < models.size(); m++)
+    {
+      std::cout << std::left << std::setw(std::max<size_t>(14, models[m].size() + 2)) << std::setprecision(3);
+      if (k < results[m].size())
+        std::cout << results[m][k].second;
+      else
+        std::cout << "-";
+    }
+    std::cout << std::endl;
   }
 
-  // Compiler should use a move
-  return timings;
+  std::cout.precision(ss);
+}
+#else
+// Construct the implementation built into this binary with the given array size
+template <typename T>
+Stream<T> *make_stream(intptr_t array_size)
+{
+  return make_model_stream<T>(array_size, deviceIndex);
 }
+#endif
 
-// Run the Triad kernel
+// Construct the stream with its threads bound and its arrays replicated per NUMA node,
+// if requested
 template <typename T>
-std::vector<std::vector<double>> run_triad(Stream<T> *stream)
+Stream<T> *create_stream(intptr_t array_size)
+{
+  Stream<T> *stream = make_stream<T>(array_size);
+  if (!binding.empty())
+  {
+    // The binding decides the number of threads where the model lets it
+    stream->set_num_threads(binding.size());
+    if (!stream->set_affinity(binding))
+    {
+      std::cerr << "--bind is not supported by " << implementation << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (numa_policy == NumaPolicy::Replicate && !stream->set_replicated(true))
+  {
+    std::cerr << "--numa replicate is not supported by " << implementation << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (inner_reps > 1 && !stream->set_inner_reps(inner_reps))
+  {
+    std::cerr << "--inner-reps is not supported by " << implementation << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return stream;
+}
+
+// Print which NUMA node and L3 domain the cores and CPUs of the host belong to, and the CPU
+// each thread of the model is bound to
+void report_binding()
 {
+  struct Domain
+  {
+    std::vector<int> cores, cpus;
+  };
+  const std::vector<CpuPlace> places = cpuPlaces();
+  std::map<std::pair<int, int>, Domain> domains;
+  std::set<int> nodes, l3s, cores;
+  for (const CpuPlace& place : places)
+  {
+    Domain& domain = domains[std::make_pair(place.node, place.l3)];
+    domain.cores.push_back(place.core);
+    domain.cpus.push_back(place.cpu);
+    nodes.insert(place.node);
+    l3s.insert(place.l3);
+    cores.insert(place.core);
+  }
 
-  std::vector<std::vector<double>> timings(1);
+  if (places.empty())
+    std::cout << "Topology: unavailable" << std::endl;
+  else
+    std::cout << "Topology: " << nodes.size() << " NUMA node(s), " << l3s.size() << " L3 domain(s), "
+      << cores.size() << " core(s), " << places.size() << " CPU(s)" << std::endl;
+  for (const std::pair<const std::pair<int, int>, Domain>& domain : domains)
+    std::cout << "  Node " << domain.first.first << ", L3 " << domain.first.second
+      << ": cores " << formatCpuList(domain.second.cores) << ", CPUs " << formatCpuList(domain.second.cpus) << std::endl;
+
+  if (binding.empty())
+  {
+    std::cout << "Binding: none" << std::endl;
+    return;
+  }
+  std::cout << "Binding: " << binding.size() << " thread(s) on CPUs";
+  for (size_t thread = 0; thread < binding.size(); thread++)
+    std::cout << (thread == 0 ? " " : ",") << binding[thread];
+  std::cout << std::endl;
+}
+
+// Print how much of the arrays allocated through PageAllocator is backed by huge pages,
+// and on which NUMA nodes it is
+void report_pages()
+{
+#ifdef BABELSTREAM_PLUGINS
+  const PageUsage usage = plugin->page_usage();
+#else
+  const PageUsage usage = pageUsage();
+#endif
+  // Nothing resident means the model allocates some other way, or smaps is unavailable
+  if (usage.resident == 0)
+    return;
+
+  const double scale = bandwidth_scale();
+  const char *unit = mibibytes ? " MiB" : " MB";
+  std::streamsize ss = std::cout.precision();
+  std::cout << std::setprecision(1) << std::fixed
+    << "Huge pages: " << (usage.thp + usage.hugetlb) * scale << " of " << usage.resident * scale << unit
+    << " resident (THP " << usage.thp * scale << unit << ", hugetlb " << usage.hugetlb * scale << unit << ")"
+    << std::endl;
+  if (!usage.nodes.empty())
+  {
+    size_t total = 0;
+    for (const std::pair<int, size_t>& node : usage.nodes)
+      total += node.second;
+    std::cout << "NUMA placement:";
+    for (const std::pair<int, size_t>& node : usage.nodes)
+      std::cout << " node " << node.first << " " << 100.0 * node.second / total << "%";
+    std::cout << std::endl;
+  }
+  std::cout.precision(ss);
+}
+
+
+
+// Wait for the other concurrent benchmarks, if any
+void sync_kernels()
+{
+  if (kernel_barrier)
+    kernel_barrier();
+}
 
+// Start counting events for a kernel, if counters are enabled
+void start_counters()
+{
+  if (counters)
+    counters->start();
+}
+
+// Attribute the events counted since start_counters() to a kernel
+void stop_counters(size_t kernel)
+{
+  if (counters)
+    counters->stop(kernel);
+}
+
+// Run one iteration of the 5 main kernels, appending their times
+template <typename T>
+void run_all_iteration(Stream<T> *stream, std::vector<std::vector<double>>& timings, T& sum)
+{
   // Declare timers
   std::chrono::high_resolution_clock::time_point t1, t2;
 
-  // Run triad in loop
+  // Execute Copy
+  sync_kernels();
+  start_counters();
+  t1 = std::chrono::high_resolution_clock::now();
+  stream->copy();
+  t2 = std::chrono::high_resolution_clock::now();
+  stop_counters(0);
+  timings[0].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+
+  // Execute Mul
+  sync_kernels();
+  start_counters();
+  t1 = std::chrono::high_resolution_clock::now();
+  stream->mul();
+  t2 = std::chrono::high_resolution_clock::now();
+  stop_counters(1);
+  timings[1].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+
+  // Execute Add
+  sync_kernels();
+  start_counters();
+  t1 = std::chrono::high_resolution_clock::now();
+  stream->add();
+  t2 = std::chrono::high_resolution_clock::now();
+  stop_counters(2);
+  timings[2].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+
+  // Execute Triad
+  sync_kernels();
+  start_counters();
+  t1 = std::chrono::high_resolution_clock::now();
+  stream->triad();
+  t2 = std::chrono::high_resolution_clock::now();
+  stop_counters(3);
+  timings[3].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+
+  // Execute Dot
+  sync_kernels();
+  start_counters();
   t1 = std::chrono::high_resolution_clock::now();
+  sum = stream->dot();
+  t2 = std::chrono::high_resolution_clock::now();
+  stop_counters(4);
+  timings[4].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+}
+
+// Run the 5 main kernels
+template <typename T>
+std::vector<std::vector<double>> run_all(Stream<T> *stream, T& sum)
+{
+
+  // List of times
+  std::vector<std::vector<double>> timings(5);
+
   for (unsigned int k = 0; k < num_times + num_warmups; k++)
   {
-    stream->triad();
+    run_all_iteration(stream, timings, sum);
   }
+
+  // Compiler should use a move
+  return timings;
+}
+
+// Run one iteration of the Triad kernel, appending its time
+template <typename T>
+void run_triad_iteration(Stream<T> *stream, std::vector<std::vector<double>>& timings)
+{
+  // Declare timers
+  std::chrono::high_resolution_clock::time_point t1, t2;
+
+  sync_kernels();
+  start_counters();
+  t1 = std::chrono::high_resolution_clock::now();
+  stream->triad();
   t2 = std::chrono::high_resolution_clock::now();
+  stop_counters(0);
+  timings[0].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+}
+
+// Run the Triad kernel
+template <typename T>
+std::vector<std::vector<double>> run_triad(Stream<T> *stream)
+{
+  std::vector<std::vector<double>> timings(1);
 
-  double runtime = std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count();
-  timings[0].push_back(runtime);
+  // Run triad in loop
+  for (unsigned int k = 0; k < num_times + num_warmups; k++)
+  {
+    run_triad_iteration(stream, timings);
+  }
 
   return timings;
 }
 
+// Run one iteration of the Nstream kernel, appending its time
+template <typename T>
+void run_nstream_iteration(Stream<T> *stream, std::vector<std::vector<double>>& timings)
+{
+  // Declare timers
+  std::chrono::high_resolution_clock::time_point t1, t2;
+
+  sync_kernels();
+  start_counters();
+  t1 = std::chrono::high_resolution_clock::now();
+  stream->nstream();
+  t2 = std::chrono::high_resolution_clock::now();
+  stop_counters(0);
+  timings[0].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+}
+
 // Run the Nstream kernel
 template <typename T>
 std::vector<std::vector<double>> run_nstream(Stream<T> *stream)
 {
   std::vector<std::vector<double>> timings(1);
 
-  // Declare timers
-  std::chrono::high_resolution_clock::time_point t1, t2;
-
   // Run nstream in loop
-  for (int k = 0; k < num_times + num_warmups; k++) {
-    t1 = std::chrono::high_resolution_clock::now();
-    stream->nstream();
-    t2 = std::chrono::high_resolution_clock::now();
-    timings[0].push_back(std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1).count());
+  for (unsigned int k = 0; k < num_times + num_warmups; k++) {
+    run_nstream_iteration(stream, timings);
   }
 
   return timings;
 
 }
 
-
-// Generic run routine
-// Runs the kernel(s) and prints output.
+// Run the selected kernels for as many iterations as needed: warm up until the kernel
+// times reach a steady state, then measure until the confidence interval of every
+// kernel is narrow enough or the time budget runs out. num_warmups and num_times are
+// updated to the number of iterations actually used.
 template <typename T>
-void run()
+std::vector<std::vector<double>> run_adaptive(Stream<T> *stream, T& sum)
 {
+  // Iterations per rolling window in the steady state test
+  const size_t window = 8;
+  // Allowed change in the rolling coefficient of variation between windows
+  const double cv_tolerance = 0.02;
+  // Fewest timed iterations before the confidence interval is trusted
+  const size_t min_times = 10;
+  // Copy/Mul/Add/Triad scale the arrays by 0.96 per iteration, stop well before denormals
+  const size_t max_iterations = selection == Benchmark::All ? 1000 : std::numeric_limits<size_t>::max();
+
+  std::vector<std::vector<double>> timings(selection == Benchmark::All ? 5 : 1);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  auto elapsed = [&]() {
+    return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+  };
+  auto iterate = [&]() {
+    if (selection == Benchmark::All)
+      run_all_iteration(stream, timings, sum);
+    else if (selection == Benchmark::Triad)
+      run_triad_iteration(stream, timings);
+    else
+      run_nstream_iteration(stream, timings);
+  };
+
+  // Warm up until all kernels are steady, using at most half of the budget
+  size_t warmups = 0;
+  bool steady = false;
+  while (!steady && warmups < max_iterations / 2 && elapsed() < time_budget / 2)
+  {
+    iterate();
+    warmups++;
+    steady = true;
+    for (const std::vector<double>& t : timings)
+      steady = steady && isSteadyState(t, window, cv_tolerance);
+  }
+
+  // Measure until the widest confidence interval is narrow enough
+  size_t times = 0;
+  double widest = std::numeric_limits<double>::infinity();
+  while (warmups + times < max_iterations)
+  {
+    iterate();
+    times++;
+    if (times < min_times)
+      continue;
+
+    widest = 0.0;
+    for (const std::vector<double>& t : timings)
+    {
+      Statistics stats = computeStatistics(std::vector<double>(t.begin() + warmups, t.end()), 0.0);
+      widest = std::max(widest, (stats.ci95_high - stats.mean) / stats.mean);
+    }
+    if (widest <= adaptive_width || elapsed() >= time_budget)
+      break;
+  }
+
+  num_warmups = warmups;
+  num_times = times;
+
+  std::ios::fmtflags flags = std::cout.flags();
   std::streamsize ss = std::cout.precision();
+  std::cout << std::fixed << std::setprecision(2)
+    << "Adaptive: " << num_warmups << " warmup iterations"
+    << (steady ? " to steady state" : " (steady state not reached)")
+    << ", " << num_times << " timed iterations"
+    << ", 95% CI within +/-" << 100.0 * widest << "%"
+    << (widest <= adaptive_width ? "" : " (target not reached)")
+    << " after " << elapsed() << " s" << std::endl;
+  std::cout.precision(ss);
+  std::cout.flags(flags);
+
+  return timings;
+}
+
+// Threads the model runs its kernels on, as far as the driver can tell
+int model_threads()
+{
+  if (!binding.empty())
+    return binding.size();
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return std::thread::hardware_concurrency();
+#endif
+}
+
+// Build and host description recorded alongside JSON results
+template <typename T>
+RunMetadata run_metadata()
+{
+  RunMetadata metadata;
+
+  char hostname[256] = "unknown";
+#if defined(__unix__) || defined(__APPLE__)
+  if (gethostname(hostname, sizeof(hostname)) != 0)
+    std::strcpy(hostname, "unknown");
+  hostname[sizeof(hostname) - 1] = '\0';
+#endif
+  metadata.hostname = hostname;
+
+  metadata.implementation = implementation;
+#ifdef BABELSTREAM_COMPILER
+  metadata.compiler = BABELSTREAM_COMPILER;
+#endif
+#ifdef BABELSTREAM_FLAGS
+  metadata.flags = BABELSTREAM_FLAGS;
+#endif
+  metadata.precision = Element<T>::description();
+
+  metadata.threads = model_threads();
+  metadata.binding = binding;
+
+  return metadata;
+}
+
+// Run the kernel(s) of the current selection, timings per sweep of the arrays
+template <typename T>
+std::vector<std::vector<double>> run_benchmark(Stream<T> *stream, T& sum)
+{
+  std::vector<std::vector<double>> timings;
+  if (adaptive_width > 0.0)
+    timings = run_adaptive<T>(stream, sum);
+  else
+  {
+    switch (selection)
+    {
+      case Benchmark::Triad:
+        timings = run_triad<T>(stream);
+        break;
+      case Benchmark::Nstream:
+        timings = run_nstream<T>(stream);
+        break;
+      case Benchmark::All:
+      default:
+        timings = run_all<T>(stream, sum);
+        break;
+    }
+  }
+
+  for (std::vector<double>& kernel : timings)
+    for (double& t : kernel)
+      t /= inner_reps;
+  return timings;
+}
+
+// Names of the kernels run by the current selection, in the order of their timings
+std::vector<std::string> kernel_labels()
+{
+  std::vector<std::string> labels;
+  switch (selection)
+  {
+    case Benchmark::Triad:
+      labels = {"Triad"};
+      break;
+    case Benchmark::Nstream:
+      labels = {"Nstream"};
+      break;
+    case Benchmark::All:
+    default:
+      labels = {"Copy", "Mul", "Add", "Triad", "Dot"};
+  }
+  if (nontemporal_pass)
+    for (std::string& label : labels)
+      label += " NT";
+  return labels;
+}
+
+// Bytes moved by a single invocation of each kernel of the current selection
+template <typename T>
+std::vector<size_t> kernel_bytes(intptr_t array_size)
+{
+  switch (selection)
+  {
+    case Benchmark::Triad:
+      return {3 * sizeof(T) * array_size};
+    case Benchmark::Nstream:
+      return {4 * sizeof(T) * array_size};
+    case Benchmark::All:
+    default:
+      return {
+        2 * sizeof(T) * array_size,
+        2 * sizeof(T) * array_size,
+        3 * sizeof(T) * array_size,
+        3 * sizeof(T) * array_size,
+        2 * sizeof(T) * array_size};
+  }
+}
+
+// Fastest time of a single invocation of each kernel, ignoring warmup iterations
+std::vector<double> best_times(const std::vector<std::vector<double>>& timings)
+{
+  std::vector<double> best;
+  for (const std::vector<double>& t : timings)
+    best.push_back(*std::min_element(t.begin() + num_warmups, t.end()));
+  return best;
+}
+
+// Label each point of a bandwidth-vs-footprint curve with the level of the memory
+// hierarchy it runs from. Consecutive points whose bandwidth stays within a tolerance
+// of the running mean form a plateau; each plateau is assigned the smallest cache
+// level (aggregated over all instances in the host) that holds its largest footprint.
+// Points between plateaus are marked as transitions with "-".
+std::vector<std::string> label_plateaus(const std::vector<double>& footprint, const std::vector<double>& bandwidth)
+{
+  const double tolerance = 0.15;
+  const std::vector<CacheLevel> caches = detectCacheLevels();
+  std::vector<std::string> labels(bandwidth.size(), "-");
+
+  size_t begin = 0;
+  int plateaus = 0;
+  while (begin < bandwidth.size())
+  {
+    size_t end = begin + 1;
+    double mean = bandwidth[begin];
+    while (end < bandwidth.size() && std::fabs(bandwidth[end] - mean) <= tolerance * mean)
+    {
+      mean += (bandwidth[end] - mean) / (end - begin + 1);
+      end++;
+    }
+
+    if (end - begin >= 2)
+    {
+      std::string label;
+      if (caches.empty())
+      {
+        label = "P" + std::to_string(++plateaus);
+      }
+      else
+      {
+        label = "DRAM";
+        for (const CacheLevel& cache : caches)
+        {
+          if (footprint[end - 1] <= (double)cache.size * cache.instances)
+          {
+            label = "L" + std::to_string(cache.level);
+            break;
+          }
+        }
+      }
+      for (size_t i = begin; i < end; i++)
+        labels[i] = label;
+    }
+    begin = end;
+  }
+  return labels;
+}
+
+// Run the selected kernels over a geometric series of array sizes, reusing the
+// allocation made for the largest size when the model supports it
+template <typename T>
+void run_sweep(Stream<T> *&stream, JsonReport *report, double timer_overhead)
+{
+  std::vector<intptr_t> sizes;
+  for (double n = sweep_min; n < ARRAY_SIZE; n = std::max(std::ceil(n * sweep_factor), n + 1))
+    sizes.push_back((intptr_t)n);
+  sizes.push_back(ARRAY_SIZE);
+
+  const std::vector<std::string> labels = kernel_labels();
+  const double scale = bandwidth_scale();
+
+  // Per kernel, one entry per size
+  std::vector<std::vector<double>> bandwidth(labels.size());
+  std::vector<std::vector<double>> runtime(labels.size());
+  std::vector<double> footprint;
+
+  bool resizable = true;
+  for (intptr_t n : sizes)
+  {
+    if (resizable && !stream->set_array_size(n))
+    {
+      resizable = false;
+      std::cout << "Note: " << implementation
+        << " cannot resize its arrays, reallocating for each size" << std::endl;
+    }
+    if (!resizable)
+    {
+      delete stream;
+      stream = create_stream<T>(n);
+    }
+
+    stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+    T sum{};
+    std::vector<std::vector<double>> timings = run_benchmark<T>(stream, sum);
+
+    check_solution<T>(stream, n, num_times + num_warmups, sum);
+
+    const std::vector<double> best = best_times(timings);
+    const std::vector<size_t> bytes = kernel_bytes<T>(n);
+    for (size_t k = 0; k < labels.size(); k++)
+    {
+      runtime[k].push_back(best[k]);
+      bandwidth[k].push_back(scale * bytes[k] / best[k]);
+      if (report)
+      {
+        std::vector<double> samples(timings[k].begin() + num_warmups, timings[k].end());
+        report->add(labels[k], n, sizeof(T), bytes[k], timings[k], num_warmups,
+          computeStatistics(samples, timer_overhead), scale, mibibytes ? "MiB/s" : "MB/s");
+      }
+    }
+    footprint.push_back(3.0 * sizeof(T) * n);
+  }
+
+  ResultTable table = result_table({
+    {"function", "Function", 12, 0},
+    {"n_elements", "Elements", 14, 0},
+    {"sizeof", "", 0, 0},
+    {"footprint_bytes", "", 0, 0},
+    {"", mibibytes ? "Footprint (KiB)" : "Footprint (KB)", 16, 1},
+    {bandwidth_csv("max"), bandwidth_heading(), 12, 3},
+    {"min_runtime", "Min (sec)", 12, 5},
+    {"level", "Level", 12, 0}});
+
+  for (size_t k = 0; k < labels.size(); k++)
+  {
+    const std::vector<std::string> level = label_plateaus(footprint, bandwidth[k]);
+    for (size_t i = 0; i < sizes.size(); i++)
+      table.row({labels[k], sizes[i], sizeof(T), (size_t)footprint[i], footprint[i] * (mibibytes ? std::pow(2.0, -10.0) : 1.0E-3),
+                 bandwidth[k][i], runtime[k][i], level[i]});
+  }
+}
+
+
+// Run the selected kernels at each thread count in thread_counts and report how the
+// bandwidth of each kernel scales, plus the fewest threads that saturate memory bandwidth
+template <typename T>
+Results run_threads_sweep(Stream<T> *stream)
+{
+  const std::vector<std::string> labels = kernel_labels();
+  const std::vector<size_t> bytes = kernel_bytes<T>(ARRAY_SIZE);
+  const double scale = bandwidth_scale();
+
+  // Per kernel, one entry per thread count
+  std::vector<std::vector<double>> bandwidth(labels.size());
+
+  for (int n : thread_counts)
+  {
+    if (!stream->set_num_threads(n))
+    {
+      std::cerr << implementation << " cannot change its thread count at runtime" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+    T sum{};
+    std::vector<std::vector<double>> timings = run_benchmark<T>(stream, sum);
+
+    check_solution<T>(stream, ARRAY_SIZE, num_times + num_warmups, sum);
+
+    const std::vector<double> best = best_times(timings);
+    for (size_t k = 0; k < labels.size(); k++)
+      bandwidth[k].push_back(scale * bytes[k] / best[k]);
+  }
+
+  ResultTable table = result_table({
+    {"function", "Function", 12, 0},
+    {"threads", "Threads", 10, 0},
+    {"n_elements", "", 0, 0},
+    {"sizeof", "", 0, 0},
+    {bandwidth_csv("max"), bandwidth_heading(), 12, 3},
+    {"speedup", "Speedup", 10, 2},
+    {"efficiency", "", 0, 0},
+    {"", "Efficiency (%)", 16, 1}});
+
+  Results results;
+  int recommended = 0;
+  std::vector<int> saturating(labels.size());
+  for (size_t k = 0; k < labels.size(); k++)
+  {
+    const double peak = *std::max_element(bandwidth[k].begin(), bandwidth[k].end());
+    saturating[k] = 0;
+    for (size_t i = 0; i < thread_counts.size(); i++)
+    {
+      // Relative to the first (usually single-threaded) run, scaled by the added threads
+      const double speedup = bandwidth[k][i] / bandwidth[k][0];
+      const double efficiency = speedup * thread_counts[0] / thread_counts[i];
+      if (bandwidth[k][i] >= saturation * peak && (saturating[k] == 0 || thread_counts[i] < saturating[k]))
+        saturating[k] = thread_counts[i];
+
+      table.row({labels[k], thread_counts[i], ARRAY_SIZE, sizeof(T), bandwidth[k][i], speedup, efficiency, 100.0 * efficiency});
+    }
+    recommended = std::max(recommended, saturating[k]);
+    results.push_back(std::make_pair(labels[k], peak));
+  }
+
+  std::streamsize ss = std::cout.precision();
+  std::cout << "--------------------------------" << std::endl
+    << "Threads reaching " << std::fixed << std::setprecision(0) << 100.0 * saturation << "% of peak bandwidth:";
+  for (size_t k = 0; k < labels.size(); k++)
+    std::cout << " " << labels[k] << "=" << saturating[k];
+  std::cout << std::endl
+    << "Recommended: " << recommended << " threads saturate all kernels" << std::endl;
+  std::cout.precision(ss);
+
+  return results;
+}
+
+// Mean absolute error of each array against its expected value; in place if the model
+// supports it, otherwise on a copy read back to the host. Returns whether it was in place.
+template <typename T>
+bool array_errors(Stream<T> *stream, intptr_t array_size, T goldA, T goldB, T goldC,
+                  double& errA, double& errB, double& errC)
+{
+  if (stream->validate(goldA, goldB, goldC, errA, errB, errC))
+    return true;
+
+  std::vector<T> a(array_size), b(array_size), c(array_size);
+  stream->read_arrays(a, b, c);
+  errA = std::accumulate(a.begin(), a.end(), 0.0L, [&](long double sum, const T val){ return sum + element_abs(val - goldA); }) / array_size;
+  errB = std::accumulate(b.begin(), b.end(), 0.0L, [&](long double sum, const T val){ return sum + element_abs(val - goldB); }) / array_size;
+  errC = std::accumulate(c.begin(), c.end(), 0.0L, [&](long double sum, const T val){ return sum + element_abs(val - goldC); }) / array_size;
+  return false;
+}
+
+// Largest average error accepted for an array whose elements should all be gold: 100
+// epsilon relative to gold, since the arrays shrink well below 1 over the iterations and
+// an absolute bound would pass even zeroed 16-bit arrays. Absolute where gold is 0.
+template <typename T>
+long double error_tolerance(T gold)
+{
+  const long double magnitude = element_abs(gold);
+  return Element<T>::epsilon() * 100.0 * (magnitude > 0.0 ? magnitude : 1.0);
+}
+
+// Run the roofline kernel for each compiled number of extra multiply-adds K up to
+// roofline_max and report the attained flop rate and bandwidth against arithmetic
+// intensity, plus the K from which the kernel stops being bandwidth bound
+template <typename T>
+Results run_roofline(Stream<T> *stream)
+{
+  // Still bandwidth bound while within this fraction of the bandwidth without extra flops
+  const double bound_fraction = 0.9;
+  const double scale = bandwidth_scale();
+  const double bytes = 3.0 * sizeof(T) * ARRAY_SIZE;
+
+  std::vector<unsigned int> fmas;
+  for (unsigned int k : roofline_fmas)
+    if (k <= (unsigned int)roofline_max)
+      fmas.push_back(k);
+
+  stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+
+  std::vector<double> bandwidth, gflops, intensity;
+  for (unsigned int k : fmas)
+  {
+    std::vector<double> timings;
+    for (unsigned int i = 0; i < num_times + num_warmups; i++)
+    {
+      auto t1 = std::chrono::high_resolution_clock::now();
+      if (!stream->roofline(k))
+      {
+        std::cerr << implementation << " does not implement the roofline kernel" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      auto t2 = std::chrono::high_resolution_clock::now();
+      timings.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count());
+    }
+
+    const double best = *std::min_element(timings.begin() + num_warmups, timings.end());
+    const double flops = (2.0 + 2.0 * k) * ARRAY_SIZE;
+    bandwidth.push_back(scale * bytes / best);
+    gflops.push_back(1.0E-9 * flops / best);
+    intensity.push_back(flops / bytes);
+  }
+
+  // Only a changes, to the same value every iteration
+  const T scalar = Element<T>::scalar();
+  T goldA = Element<T>::initB() + scalar * Element<T>::initC();
+  for (unsigned int k = 0; k < fmas.back(); k++)
+    goldA = goldA * scalar + Element<T>::initC();
+  double errA, errB, errC;
+  array_errors(stream, ARRAY_SIZE, goldA, Element<T>::initB(), Element<T>::initC(), errA, errB, errC);
+  if (errA > error_tolerance(goldA) || errB > error_tolerance(Element<T>::initB())
+      || errC > error_tolerance(Element<T>::initC()))
+    std::cerr
+      << "Validation failed on roofline kernel. Average error a[] " << errA
+      << ", b[] " << errB << ", c[] " << errC << std::endl;
+
+  ResultTable table = result_table({
+    {"fmas", "FMAs", 8, 0},
+    {"n_elements", "", 0, 0},
+    {"sizeof", "", 0, 0},
+    {"flops_per_byte", "Flops/byte", 14, 3},
+    {"gflops_per_sec", "GFlops/sec", 12, 3},
+    {bandwidth_csv("max"), bandwidth_heading(), 12, 3},
+    {"bound", "Bound", 12, 0}});
+
+  Results results;
+  int crossover = -1;
+  for (size_t i = 0; i < fmas.size(); i++)
+  {
+    const bool memory_bound = bandwidth[i] >= bound_fraction * bandwidth[0];
+    if (!memory_bound && crossover < 0)
+      crossover = i;
+
+    table.row({fmas[i], ARRAY_SIZE, sizeof(T), intensity[i], gflops[i], bandwidth[i], memory_bound ? "memory" : "compute"});
+    results.push_back(std::make_pair("FMAs=" + std::to_string(fmas[i]), bandwidth[i]));
+  }
+
+  // Where the measured compute and bandwidth ceilings meet
+  const double peak_gflops = *std::max_element(gflops.begin(), gflops.end());
+  const double peak_bandwidth = *std::max_element(bandwidth.begin(), bandwidth.end());
+  std::streamsize ss = std::cout.precision();
+  std::cout << "--------------------------------" << std::endl << std::fixed
+    << "Peak: " << std::setprecision(3) << peak_gflops << " GFlops/sec, "
+    << peak_bandwidth << " " << bandwidth_heading() << std::endl
+    << "Ridge point: " << peak_gflops * 1.0E9 / (peak_bandwidth / scale) << " flops/byte" << std::endl;
+  if (crossover < 0)
+    std::cout << "Bandwidth bound up to " << fmas.back() << " FMAs per element, increase --roofline to find the crossover" << std::endl;
+  else
+    std::cout << "Compute bound from " << fmas[crossover] << " FMAs per element ("
+      << intensity[crossover] << " flops/byte)" << std::endl;
+  std::cout.precision(ss);
+
+  return results;
+}
+
+// Run the R:W mix kernel for each pair in mix_ratios and report read, write and total
+// bandwidth. Bytes moved are (R + W) * sizeof(T) per element; write-allocate reads of the
+// outputs, which most caches add for non-streaming stores, are not counted.
+template <typename T>
+Results run_mix(Stream<T> *stream)
+{
+  const double scale = bandwidth_scale();
+
+  ResultTable table = result_table({
+    {"reads", "", 0, 0},
+    {"writes", "", 0, 0},
+    {"", "R:W", 8, 0},
+    {"n_elements", "", 0, 0},
+    {"sizeof", "", 0, 0},
+    {bandwidth_csv("max"), bandwidth_heading(), 12, 3},
+    {bandwidth_csv("read"), "Read", 12, 3},
+    {bandwidth_csv("write"), "Write", 12, 3},
+    {"min_runtime", "Min (sec)", 12, 5},
+    {"max_runtime", "Max", 12, 5},
+    {"avg_runtime", "Average", 12, 5}});
+
+  Results results;
+  for (const std::pair<unsigned int, unsigned int>& ratio : mix_ratios)
+  {
+    const unsigned int reads = ratio.first, writes = ratio.second;
+    T sum{};
+    std::vector<double> timings;
+    for (unsigned int i = 0; i < num_times + num_warmups; i++)
+    {
+      auto t1 = std::chrono::high_resolution_clock::now();
+      if (!stream->mix(reads, writes, sum))
+      {
+        std::cerr << implementation << " does not implement the " << reads << ":" << writes << " mix kernel" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      auto t2 = std::chrono::high_resolution_clock::now();
+      timings.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count());
+    }
+
+    // Every array holds initB, so the inputs sum to R * initB per element. The outputs
+    // are checked by reading them back as the inputs of a W:0 kernel.
+    typedef typename Element<T>::Wide Wide;
+    Wide expected = Wide(Element<T>::initB()) * (long double)reads * (long double)ARRAY_SIZE;
+    if (writes > 0)
+    {
+      stream->mix(writes, 0, sum);
+      expected = Wide(Element<T>::initB()) * (long double)writes * (long double)ARRAY_SIZE;
+    }
+    // The kernels sum in Element<T>::MixSum and round to T once, so allow that rounding, as
+    // the dot product of 16-bit types does, but no less than its 1e-8
+    const long double tolerance = std::max(1.0E-8L, Element<T>::epsilon());
+    const long double error = element_abs((Wide(sum) - expected) / expected);
+    if (element_abs(expected) > Element<T>::max())
+      std::cout
+        << "Sum not checked: " << Element<T>::description() << " cannot hold the sum of the "
+        << reads << ":" << writes << " mix kernel" << std::endl;
+    else if (error > tolerance)
+      std::cerr
+        << "Validation failed on " << reads << ":" << writes << " mix kernel. Sum relative error "
+        << error << std::endl;
+
+    auto minmax = std::minmax_element(timings.begin() + num_warmups, timings.end());
+    const double average = std::accumulate(timings.begin() + num_warmups, timings.end(), 0.0) / (double)num_times;
+    const double element_bytes = (double)sizeof(T) * ARRAY_SIZE / *minmax.first;
+    const double bandwidth = scale * (reads + writes) * element_bytes;
+    const double read_bandwidth = scale * reads * element_bytes;
+    const double write_bandwidth = scale * writes * element_bytes;
+    const std::string label = std::to_string(reads) + ":" + std::to_string(writes);
+
+    table.row({reads, writes, label, ARRAY_SIZE, sizeof(T), bandwidth, read_bandwidth, write_bandwidth,
+               *minmax.first, *minmax.second, average});
+    results.push_back(std::make_pair("Mix " + label, bandwidth));
+  }
+
+  return results;
+}
+
+// Run strided copy and triad for each power-of-two stride up to strided_pages pages and
+// report effective bandwidth, counting only the elements used, and line bandwidth,
+// counting every cache line the kernel has to move
+template <typename T>
+Results run_strided(Stream<T> *stream)
+{
+  const double scale = bandwidth_scale();
+  size_t line = cacheLineSize();
+  if (line == 0)
+    line = 64;
+  size_t page = 4096;
+#if defined(__unix__) || defined(__APPLE__)
+  page = sysconf(_SC_PAGESIZE);
+#endif
+
+  std::vector<intptr_t> strides;
+  for (intptr_t stride = 1; stride < ARRAY_SIZE && stride * sizeof(T) <= strided_pages * page; stride *= 2)
+    strides.push_back(stride);
+
+  // One CSV row per kernel, one printed row per stride with copy and triad side by side
+  ResultTable csv = result_table({
+    {"function", "", 0, 0},
+    {"stride", "", 0, 0},
+    {"stride_bytes", "", 0, 0},
+    {"n_elements", "", 0, 0},
+    {"sizeof", "", 0, 0},
+    {bandwidth_csv("max"), "", 0, 0},
+    {bandwidth_csv("line"), "", 0, 0},
+    {"min_runtime", "", 0, 0}});
+  std::cout << "Cache line: " << line << " bytes, page: " << page << " bytes" << std::endl;
+  ResultTable table({
+    {"", "Stride", 10, 0},
+    {"", "Bytes", 12, 0},
+    {"", "Copy", 12, 3},
+    {"", "Copy lines", 12, 3},
+    {"", "Triad", 12, 3},
+    {"", "Triad lines", 12, 3},
+    {"", "Useful", 12, 3}}, "", csv_separator);
+
+  const char *labels[2] = {"Copy", "Triad"};
+  const int arrays[2] = {2, 3};
+
+  Results results;
+  // Only used where the model cannot validate in place
+  std::vector<T> a, b, c;
+  for (intptr_t stride : strides)
+  {
+    stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+
+    double best[2];
+    for (int k = 0; k < 2; k++)
+    {
+      std::vector<double> timings;
+      for (unsigned int i = 0; i < num_times + num_warmups; i++)
+      {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        const bool supported = k == 0 ? stream->strided_copy(stride) : stream->strided_triad(stride);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        if (!supported)
+        {
+          std::cerr << implementation << " does not implement the strided kernels" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+        timings.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count());
+      }
+      best[k] = *std::min_element(timings.begin() + num_warmups, timings.end());
+    }
+
+    // Touched elements end up as c = a and a = b + scalar * c, the rest keep their start values
+    const T touchedA = Element<T>::initB() + Element<T>::scalar() * Element<T>::initA();
+    double errA, errB, errC;
+    if (!stream->validate_strided(stride, touchedA, Element<T>::initB(), Element<T>::initA(),
+                                  Element<T>::initA(), Element<T>::initB(), Element<T>::initC(), errA, errB, errC))
+    {
+      // Read back into host copies kept across strides
+      if (a.empty())
+      {
+        a.resize(ARRAY_SIZE);
+        b.resize(ARRAY_SIZE);
+        c.resize(ARRAY_SIZE);
+      }
+      stream->read_arrays(a, b, c);
+      long double sumA = 0.0, sumB = 0.0, sumC = 0.0;
+      for (intptr_t i = 0; i < ARRAY_SIZE; i++)
+      {
+        const bool touched = i % stride == 0;
+        sumA += element_abs(a[i] - (touched ? touchedA : Element<T>::initA()));
+        sumB += element_abs(b[i] - Element<T>::initB());
+        sumC += element_abs(c[i] - (touched ? Element<T>::initA() : Element<T>::initC()));
+      }
+      errA = sumA / ARRAY_SIZE;
+      errB = sumB / ARRAY_SIZE;
+      errC = sumC / ARRAY_SIZE;
+    }
+    // a[] and c[] hold two values each, so bound them by the smaller
+    if (errA > std::min(error_tolerance(touchedA), error_tolerance(Element<T>::initA()))
+        || errB > error_tolerance(Element<T>::initB())
+        || errC > std::min(error_tolerance(Element<T>::initA()), error_tolerance(Element<T>::initC())))
+      std::cerr << "Validation failed on strided kernels with stride " << stride << ". Average error a[] "
+        << errA << ", b[] " << errB << ", c[] " << errC << std::endl;
+
+    // Below a line apart every line of the arrays is moved, from then on one per element
+    const intptr_t elements = (ARRAY_SIZE + stride - 1) / stride;
+    const double stride_bytes = (double)stride * sizeof(T);
+    const double useful = (double)elements * sizeof(T);
+    const double lines = stride_bytes < line ? std::ceil((double)ARRAY_SIZE * sizeof(T) / line) : (double)elements;
+
+    double effective[2], raw[2];
+    for (int k = 0; k < 2; k++)
+    {
+      effective[k] = scale * arrays[k] * useful / best[k];
+      raw[k] = scale * arrays[k] * lines * line / best[k];
+      csv.row({labels[k], stride, (size_t)stride_bytes, ARRAY_SIZE, sizeof(T), effective[k], raw[k], best[k]});
+      results.push_back(std::make_pair(std::string(labels[k]) + " S=" + std::to_string(stride), effective[k]));
+    }
+    table.row({stride, (size_t)stride_bytes, effective[0], raw[0], effective[1], raw[1], useful / (lines * line)});
+  }
+
+  return results;
+}
+
+// Check 64-bit sizes and indices without the memory of a full run. The arrays of more than
+// 2^31 elements are mapped sparse and only their first elements are initialised; strided
+// copy and triad then touch elements at offsets around and past 2^31. An index that wraps
+// at 32 bits faults before the arrays or overwrites their first elements, which are read
+// back and checked, so the check exits with an error if any differ.
+template <typename T>
+Results run_index_check(Stream<T> *stream)
+{
+  const intptr_t head = 4096;
+  if (!stream->set_array_size(head))
+  {
+    std::cerr << implementation << " cannot restrict its kernels to part of the arrays, which --check-indices needs" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+  stream->set_array_size(ARRAY_SIZE);
+
+  // Last elements just below, at and past 2^31
+  const intptr_t strides[] = {(intptr_t)1 << 30, ((intptr_t)1 << 31) - 1, (intptr_t)1 << 31, ((intptr_t)1 << 31) + 1};
+
+  ResultTable table({
+    {"", "Stride", 12, 0},
+    {"", "Elements", 12, 0},
+    {"", "Last index", 12, 0}}, "", csv_separator);
+
+  // Element 0 goes through every copy and triad, the rest of the head keeps its start values
+  T goldA = Element<T>::initA();
+  T goldC = Element<T>::initC();
+  for (intptr_t stride : strides)
+  {
+    if (!stream->strided_copy(stride) || !stream->strided_triad(stride))
+    {
+      std::cerr << implementation << " does not implement the strided kernels" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    goldC = goldA;
+    goldA = Element<T>::initB() + Element<T>::scalar() * goldC;
+
+    const intptr_t elements = (ARRAY_SIZE + stride - 1) / stride;
+    table.row({stride, elements, (elements - 1) * stride});
+  }
+
+  stream->set_array_size(head);
+  std::vector<T> a(head), b(head), c(head);
+  stream->read_arrays(a, b, c);
+  stream->set_array_size(ARRAY_SIZE);
+  report_pages();
+
+  intptr_t errors = 0;
+  for (intptr_t i = 0; i < head; i++)
+  {
+    const T expectA = i == 0 ? goldA : Element<T>::initA();
+    const T expectC = i == 0 ? goldC : Element<T>::initC();
+    errors += element_abs(a[i] - expectA) > error_tolerance(expectA)
+      || element_abs(b[i] - Element<T>::initB()) > error_tolerance(Element<T>::initB())
+      || element_abs(c[i] - expectC) > error_tolerance(expectC);
+  }
+  if (errors > 0)
+  {
+    std::cerr << "Index check failed: " << errors << " of the first " << head << " elements differ" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  std::cout << "Indices past 2^31 left the first " << head << " elements intact" << std::endl;
+
+  return Results();
+}
+
+// Time num_times + num_warmups calls of a kernel that returns false if unsupported,
+// returning the best time
+double best_time(const std::function<bool()>& kernel, const char *name)
+{
+  std::vector<double> timings;
+  for (unsigned int i = 0; i < num_times + num_warmups; i++)
+  {
+    auto t1 = std::chrono::high_resolution_clock::now();
+    const bool supported = kernel();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    if (!supported)
+    {
+      std::cerr << implementation << " does not implement the " << name << " kernel" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    timings.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count());
+  }
+  return *std::min_element(timings.begin() + num_warmups, timings.end());
+}
+
+// Run gather and scatter through each of index_patterns and report their bandwidth,
+// counting the index array, next to that of copy
+template <typename T>
+Results run_indirect(Stream<T> *stream)
+{
+  const double scale = bandwidth_scale();
+  const double bytes = (2.0 * sizeof(T) + sizeof(intptr_t)) * ARRAY_SIZE;
+
+  stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+  const double copy = scale * 2.0 * sizeof(T) * ARRAY_SIZE / best_time([&]{ stream->copy(); return true; }, "copy");
+
+  std::streamsize ss = std::cout.precision();
+  std::cout << "Copy: " << std::fixed << std::setprecision(3) << copy << " " << bandwidth_heading() << std::endl;
+  std::cout.precision(ss);
+  // One CSV row per kernel, one printed row per pattern with gather and scatter side by side
+  ResultTable csv = result_table({
+    {"function", "", 0, 0},
+    {"pattern", "", 0, 0},
+    {"n_elements", "", 0, 0},
+    {"sizeof", "", 0, 0},
+    {"sizeof_index", "", 0, 0},
+    {bandwidth_csv("max"), "", 0, 0},
+    {"fraction_of_copy", "", 0, 0},
+    {"min_runtime", "", 0, 0}});
+  ResultTable table({
+    {"", "Pattern", 16, 0},
+    {"", "Gather", 12, 3},
+    {"", "Scatter", 12, 3},
+    {"", "Gather/copy", 12, 3},
+    {"", "Scatter/copy", 12, 3}}, "", csv_separator);
+
+  Results results;
+  for (const IndexPattern& pattern : index_patterns)
+  {
+    if (!stream->set_indices(makeIndices(pattern, ARRAY_SIZE)))
+    {
+      std::cerr << implementation << " does not implement the gather and scatter kernels" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // Every pattern is a permutation and b holds initB throughout, so both kernels leave
+    // initB in all of a
+    const char *labels[2] = {"Gather", "Scatter"};
+    double bandwidth[2];
+    for (int k = 0; k < 2; k++)
+    {
+      stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+      const double best = k == 0
+        ? best_time([&]{ return stream->gather(); }, "gather")
+        : best_time([&]{ return stream->scatter(); }, "scatter");
+      bandwidth[k] = scale * bytes / best;
+
+      double errA, errB, errC;
+      array_errors(stream, ARRAY_SIZE, Element<T>::initB(), Element<T>::initB(), Element<T>::initC(), errA, errB, errC);
+      if (errA > error_tolerance(Element<T>::initB()) || errB > error_tolerance(Element<T>::initB())
+          || errC > error_tolerance(Element<T>::initC()))
+        std::cerr
+          << "Validation failed on " << labels[k] << " with " << pattern.name() << " indices. Average error a[] "
+          << errA << ", b[] " << errB << ", c[] " << errC << std::endl;
+
+      csv.row({labels[k], pattern.name(), ARRAY_SIZE, sizeof(T), sizeof(intptr_t), bandwidth[k], bandwidth[k] / copy, best});
+      results.push_back(std::make_pair(std::string(labels[k]) + " " + pattern.name(), bandwidth[k]));
+    }
+    table.row({pattern.name(), bandwidth[0], bandwidth[1], bandwidth[0] / copy, bandwidth[1] / copy});
+  }
+
+  return results;
+}
+
+// Chase a list of each size per thread with each number of chains, and report the time
+// per load of a chain, which with one chain is the load-to-use latency, and the misses
+// each thread keeps in flight: by Little's law, loads completed per ns times the latency
+// of a lone chain through a list of the same size
+template <typename T>
+Results run_latency(Stream<T> *stream)
+{
+  const double scale = bandwidth_scale();
+  const double kib = mibibytes ? 1024.0 : 1000.0;
+  // Loads per chain in each timed call: a few ms from DRAM, long enough to time from L1
+  const intptr_t steps = 1 << 18;
+  const std::vector<CacheLevel> caches = detectCacheLevels();
+
+  std::vector<size_t> sizes;
+  for (size_t bytes = 4096; bytes <= latency_bytes; bytes *= 2)
+    sizes.push_back(bytes);
+  std::vector<unsigned int> chains;
+  for (unsigned int n = 1; n < latency_chains; n *= 2)
+    chains.push_back(n);
+  chains.push_back(latency_chains);
+
+  std::cout << steps << " loads per chain, " << CHASE_LINE_BYTES << " bytes each" << std::endl;
+  ResultTable table = result_table({
+    {"function", "", 0, 0},
+    {"bytes_per_thread", "", 0, 0},
+    {"", mibibytes ? "List (KiB)" : "List (KB)", 16, 0},
+    {"level", "Level", 8, 0},
+    {"chains", "Chains", 8, 0},
+    {"ns_per_load", "ns/load", 12, 3},
+    {"misses_in_flight", "In flight", 12, 2},
+    {bandwidth_csv("max"), bandwidth_heading(), 12, 3},
+    {"min_runtime", "", 0, 0}});
+
+  Results results;
+  for (size_t bytes : sizes)
+  {
+    if (!stream->set_chase(bytes))
+    {
+      std::cerr << implementation << " does not implement the latency kernels" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // Smallest cache the list of one thread fits in
+    std::string level = "DRAM";
+    for (const CacheLevel& cache : caches)
+      if (bytes <= cache.size)
+      {
+        level = "L" + std::to_string(cache.level);
+        break;
+      }
+
+    double lone = 0.0;
+    for (unsigned int n : chains)
+    {
+      const double best = best_time([&]{ return stream->chase(n, steps); }, "chase");
+      const double ns = 1.0E9 * best / steps;
+      if (n == 1)
+        lone = ns;
+      const double in_flight = n * lone / ns;
+      const double bandwidth = scale * n * steps * CHASE_LINE_BYTES / best;
+
+      table.row({"Chase", bytes, bytes / kib, level, n, ns, in_flight, bandwidth, best});
+      results.push_back(std::make_pair("Chase " + std::to_string(bytes) + "x" + std::to_string(n), bandwidth));
+    }
+  }
+
+  return results;
+}
+
+// Time single calls of each main kernel on empty arrays and on one element per thread,
+// so that what is left is the cost of starting and ending a parallel kernel in the model
+template <typename T>
+Results run_launch(Stream<T> *stream, double timer_overhead)
+{
+  const int threads = std::max(1, model_threads());
+  const std::vector<intptr_t> sizes = {0, std::min<intptr_t>(threads, ARRAY_SIZE)};
+  const std::vector<std::pair<std::string, std::function<void()>>> kernels = {
+    {"Copy", [&]{ stream->copy(); }},
+    {"Mul", [&]{ stream->mul(); }},
+    {"Add", [&]{ stream->add(); }},
+    {"Triad", [&]{ stream->triad(); }},
+    {"Nstream", [&]{ stream->nstream(); }},
+    {"Dot", [&]{ stream->dot(); }}};
+
+  std::cout << threads << " thread(s), min with the timer overhead subtracted" << std::endl;
+  ResultTable table = result_table({
+    {"function", "Function", 12, 0},
+    {"n_elements", "Elements", 12, 0},
+    {"calls", "", 0, 0},
+    {"min_us", "Min (us)", 12, 3},
+    {"median_us", "Median", 12, 3},
+    {"p95_us", "p95", 12, 3},
+    {"p99_us", "p99", 12, 3},
+    {"max_us", "Max", 12, 3}});
+
+  Results results;
+  for (intptr_t n : sizes)
+  {
+    if (!stream->set_array_size(n))
+    {
+      std::cerr << implementation << " cannot resize its arrays, which --launch needs" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+
+    for (const std::pair<std::string, std::function<void()>>& kernel : kernels)
+    {
+      std::vector<double> samples;
+      for (unsigned int i = 0; i < num_warmups + launch_calls; i++)
+      {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        kernel.second();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        if (i >= num_warmups)
+          samples.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count());
+      }
+      const Statistics stats = computeStatistics(samples, timer_overhead);
+
+      table.row({kernel.first, n, launch_calls, 1.0E6 * stats.min_corrected, 1.0E6 * stats.median,
+                 1.0E6 * stats.p95, 1.0E6 * stats.p99, 1.0E6 * stats.max});
+      results.push_back(std::make_pair(kernel.first + " " + std::to_string(n), 1.0E6 * stats.median));
+    }
+  }
+
+  return results;
+}
+
+// Run the selected kernels for soak_duration seconds. Every soak_window iterations,
+// report the bandwidth of each kernel over that window and check the arrays against
+// their expected values, so that throttling, degradation over time and silent data
+// corruption show up while the run is still going.
+template <typename T>
+Results run_soak(Stream<T> *stream)
+{
+  const std::vector<std::string> labels = kernel_labels();
+  const std::vector<size_t> bytes = kernel_bytes<T>(ARRAY_SIZE);
+  const double scale = bandwidth_scale();
+
+  // Every window starts from the initial values, so the expected values are fixed
+  T goldA, goldB, goldC;
+  gold_values<T>(soak_window, goldA, goldB, goldC);
+
+  std::ofstream csv_file(csv_filename);
+  if (output_as_csv)
+  {
+    csv_file
+      << "window" << csv_separator
+      << "elapsed" << csv_separator
+      << "function" << csv_separator
+      << "n_elements" << csv_separator
+      << "sizeof" << csv_separator
+      << bandwidth_csv("avg") << csv_separator
+      << bandwidth_csv("max") << csv_separator
+      << "valid" << std::endl;
+  }
+
+  std::cout
+    << std::left << std::setw(8) << "Window"
+    << std::left << std::setw(12) << "Time (s)";
+  for (const std::string& label : labels)
+    std::cout << std::left << std::setw(12) << label;
+  std::cout << "Validation (" << bandwidth_heading() << " per window)" << std::endl;
+
+  std::vector<double> lowest(labels.size(), std::numeric_limits<double>::max());
+  std::vector<double> highest(labels.size(), 0.0);
+  unsigned long windows = 0, failures = 0;
+
+  std::streamsize ss = std::cout.precision();
+  auto start = std::chrono::high_resolution_clock::now();
+  double elapsed = 0.0;
+  do
+  {
+    // Restart from the initial values: over a long run the kernels would otherwise drive
+    // the arrays towards denormals (Copy/Mul/Add/Triad) or ever larger values (Nstream)
+    stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+
+    std::vector<std::vector<double>> timings(labels.size());
+    T sum{};
+    for (unsigned int k = 0; k < soak_window; k++)
+    {
+      if (selection == Benchmark::All)
+        run_all_iteration(stream, timings, sum);
+      else if (selection == Benchmark::Triad)
+        run_triad_iteration(stream, timings);
+      else
+        run_nstream_iteration(stream, timings);
+    }
+
+    // Check the arrays while they are still resident
+    double errA, errB, errC;
+    array_errors(stream, ARRAY_SIZE, goldA, goldB, goldC, errA, errB, errC);
+    const bool valid = errA <= error_tolerance(goldA) && errB <= error_tolerance(goldB) && errC <= error_tolerance(goldC);
+    if (!valid)
+    {
+      failures++;
+      std::cerr
+        << "Validation failed in window " << windows << ". Average error a[] " << errA
+        << ", b[] " << errB << ", c[] " << errC << std::endl;
+    }
+
+    elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout
+      << std::left << std::setw(8) << windows
+      << std::left << std::setw(12) << std::fixed << std::setprecision(2) << elapsed
+      << std::setprecision(3);
+    for (size_t k = 0; k < labels.size(); k++)
+    {
+      const double total = std::accumulate(timings[k].begin(), timings[k].end(), 0.0);
+      const double average = scale * bytes[k] * soak_window / total;
+      const double best = scale * bytes[k] / *std::min_element(timings[k].begin(), timings[k].end());
+      lowest[k] = std::min(lowest[k], average);
+      highest[k] = std::max(highest[k], average);
+
+      std::cout << std::left << std::setw(12) << average;
+      if (output_as_csv)
+      {
+        csv_file
+          << windows << csv_separator
+          << elapsed << csv_separator
+          << labels[k] << csv_separator
+          << ARRAY_SIZE << csv_separator
+          << sizeof(T) << csv_separator
+          << average << csv_separator
+          << best << csv_separator
+          << (valid ? "true" : "false") << std::endl;
+      }
+    }
+    std::cout << (valid ? "ok" : "FAILED") << std::endl;
+
+    windows++;
+  } while (elapsed < soak_duration);
+
+  std::cout
+    << "--------------------------------" << std::endl
+    << windows << " windows of " << soak_window << " iterations in " << std::setprecision(2) << elapsed << " s, "
+    << failures << " failed validation" << std::endl;
+  std::cout.precision(ss);
+
+  // The CSV file already has every window
+  ResultTable table({
+    {"", "Function", 12, 0},
+    {"", "Highest", 12, 3},
+    {"", "Lowest", 12, 3},
+    {"", "Drop (%)", 12, 2}}, "", csv_separator);
+  Results results;
+  for (size_t k = 0; k < labels.size(); k++)
+  {
+    table.row({labels[k], highest[k], lowest[k], 100.0 * (highest[k] - lowest[k]) / highest[k]});
+    results.push_back(std::make_pair(labels[k], highest[k]));
+  }
+
+  return results;
+}
+
+
+// Print the statistics of each kernel and record them in the CSV file and JSON report.
+// Each sample covers `streams` benchmarks running concurrently on their own arrays, so
+// the bytes moved per kernel are scaled by that number.
+template <typename T>
+Results report_timings(const std::vector<std::vector<double>>& timings, int streams,
+                       std::ofstream& csv_file, JsonReport *report, double timer_overhead)
+{
+  Results results;
+
+  ResultTable table({
+    {"function", "Function", 12, 0},
+    {"num_times", "", 0, 0},
+    {"n_elements", "", 0, 0},
+    {"sizeof", "", 0, 0},
+    {bandwidth_csv("max"), bandwidth_heading(), 12, 3},
+    {"min_runtime", "Min (sec)", 12, 5},
+    {"max_runtime", "Max", 12, 5},
+    {"avg_runtime", "Average", 12, 5},
+    {"median_runtime", "Median", 12, 5},
+    {"p5_runtime", "", 0, 0},
+    {"p95_runtime", "", 0, 0},
+    {"p99_runtime", "", 0, 0},
+    {"stddev_runtime", "", 0, 0},
+    {"cv", "", 0, 0},
+    {"", "CV (%)", 12, 2},
+    {"min_runtime_corrected", "", 0, 0},
+    {bandwidth_csv("", "_ci95_low"), "", 0, 0},
+    {bandwidth_csv("", "_ci95_high"), "", 0, 0}}, output_as_csv ? &csv_file : nullptr, csv_separator);
+
+  std::vector<std::string> labels = kernel_labels();
+  std::vector<size_t> sizes = kernel_bytes<T>(ARRAY_SIZE);
+  for (size_t& size : sizes)
+    size *= streams;
+
+  const double scale = bandwidth_scale();
+
+  for (size_t i = 0; i < timings.size(); ++i)
+  {
+    // Summarise; ignore warmup iterations
+    std::vector<double> samples(timings[i].begin() + num_warmups, timings[i].end());
+    Statistics stats = computeStatistics(samples, timer_overhead);
+
+    results.push_back(std::make_pair(labels[i], scale * sizes[i] / stats.min));
+
+    if (report)
+      report->add(labels[i], ARRAY_SIZE, sizeof(T), sizes[i], timings[i], num_warmups,
+        stats, scale, mibibytes ? "MiB/s" : "MB/s");
+
+    // The slow end of the runtime interval bounds the bandwidth from below; a fastest
+    // sample of 0 (below the timer resolution) leaves the upper bound empty
+    table.row({labels[i], num_times, ARRAY_SIZE, sizeof(T), scale * sizes[i] / stats.min,
+               stats.min, stats.max, stats.mean, stats.median, stats.p5, stats.p95, stats.p99,
+               stats.stddev, stats.cv, 100.0 * stats.cv, stats.min_corrected,
+               scale * sizes[i] / stats.ci95_high,
+               stats.ci95_low > 0.0 ? TableCell(scale * sizes[i] / stats.ci95_low) : TableCell("")});
+  }
+
+  if (selection == Benchmark::Triad && !output_as_csv)
+  {
+    // Aggregate of the timed iterations, as triad-only runs used to report it
+    const double runtime = std::accumulate(timings[0].begin() + num_warmups, timings[0].end(), 0.0);
+    const double total_bytes = 3.0 * sizeof(T) * ARRAY_SIZE * num_times * streams;
+    std::cout
+      << "--------------------------------"
+      << std::endl
+      << "Runtime (seconds): " << std::left << std::setprecision(5)
+      << runtime << std::endl
+      << "Bandwidth (" << ((mibibytes) ? "GiB/s" : "GB/s") << "):  "
+      << std::left << std::setprecision(3)
+      << ((mibibytes) ? std::pow(2.0, -30.0) : 1.0E-9) * total_bytes / runtime << std::endl;
+  }
+
+  return results;
+}
+
+// CPUs a worker of the multi-process mode is bound to, empty if it isn't bound
+std::vector<int> worker_cpus(int worker)
+{
+  if (proc_bind_numa)
+  {
+    const std::vector<std::vector<int>> nodes = numaNodeCpus();
+    if (nodes.empty())
+      return std::vector<int>();
+    return nodes[worker % nodes.size()];
+  }
+  if (proc_cpus.empty())
+    return std::vector<int>();
+  return proc_cpus[worker % proc_cpus.size()];
+}
+
+// Body of a worker process: run the kernels in lockstep with the other workers, then
+// store the errors of the arrays followed by all timings in the worker's shared slot
+template <typename T>
+void run_worker(ProcessGroup& group, int worker)
+{
+  const std::vector<int> cpus = worker_cpus(worker);
+  if (!cpus.empty() && !bindToCpus(cpus))
+  {
+    std::cerr << "Worker " << worker << ": cannot bind to its CPUs" << std::endl;
+    _exit(EXIT_FAILURE);
+  }
+
+  // Arrays are first touched after binding, so their pages are local to the worker
+  Stream<T> *stream = create_stream<T>(ARRAY_SIZE);
+  stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+
+  kernel_barrier = [&group]() { group.barrier(); };
+  T sum{};
+  std::vector<std::vector<double>> timings = run_benchmark<T>(stream, sum);
+  kernel_barrier = nullptr;
+
+  T goldA, goldB, goldC;
+  gold_values<T>(num_times + num_warmups, goldA, goldB, goldC);
+  double *slot = static_cast<double *>(group.slot(worker));
+  array_errors(stream, ARRAY_SIZE, goldA, goldB, goldC, slot[0], slot[1], slot[2]);
+
+  double *samples = slot + 3;
+  for (const std::vector<double>& t : timings)
+    samples = std::copy(t.begin(), t.end(), samples);
+
+  delete stream;
+}
+
+// Fork num_procs workers that each run the selected kernels on their own arrays, meeting
+// at a barrier before every kernel. The node-wide time of an iteration is that of the
+// slowest worker, from which the aggregate bandwidth of all workers is reported.
+template <typename T>
+Results run_processes(JsonReport *report, double timer_overhead)
+{
+  const std::vector<std::string> labels = kernel_labels();
+  const std::vector<size_t> bytes = kernel_bytes<T>(ARRAY_SIZE);
+  const double scale = bandwidth_scale();
+  const size_t iterations = num_times + num_warmups;
+
+  ProcessGroup group(num_procs, (3 + labels.size() * iterations) * sizeof(double));
+  const int worker = group.fork();
+  if (worker >= 0)
+  {
+    run_worker<T>(group, worker);
+    std::cout.flush();
+    _exit(EXIT_SUCCESS);
+  }
+
+  if (group.wait() > 0)
+  {
+    std::cerr << "Error: worker processes failed" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // Workers check their arrays against the values after every iteration, see run_worker
+  T goldA, goldB, goldC;
+  gold_values<T>(iterations, goldA, goldB, goldC);
+
+  // Per worker, the timings of each kernel; across workers, the slowest of each iteration
+  std::vector<std::vector<std::vector<double>>> worker_timings(num_procs);
+  std::vector<std::vector<double>> timings(labels.size(), std::vector<double>(iterations, 0.0));
+  for (unsigned int w = 0; w < num_procs; w++)
+  {
+    const double *slot = static_cast<const double *>(group.slot(w));
+    if (slot[0] > error_tolerance(goldA) || slot[1] > error_tolerance(goldB) || slot[2] > error_tolerance(goldC))
+      std::cerr
+        << "Validation failed on worker " << w << ". Average error a[] " << slot[0]
+        << ", b[] " << slot[1] << ", c[] " << slot[2] << std::endl;
+
+    const double *samples = slot + 3;
+    for (size_t k = 0; k < labels.size(); k++)
+    {
+      worker_timings[w].push_back(std::vector<double>(samples, samples + iterations));
+      for (size_t i = 0; i < iterations; i++)
+        timings[k][i] = std::max(timings[k][i], samples[i]);
+      samples += iterations;
+    }
+  }
+
+  std::streamsize ss = std::cout.precision();
+  std::cout
+    << std::left << std::setw(8) << "Worker"
+    << std::left << std::setw(16) << "CPUs";
+  for (const std::string& label : labels)
+    std::cout << std::left << std::setw(12) << label;
+  std::cout << "(" << bandwidth_heading() << ")" << std::endl << std::fixed;
+  for (unsigned int w = 0; w < num_procs; w++)
+  {
+    const std::vector<int> cpus = worker_cpus(w);
+    std::cout
+      << std::left << std::setw(8) << w
+      << std::left << std::setw(16) << (cpus.empty() ? "any" : formatCpuList(cpus));
+    const std::vector<double> best = best_times(worker_timings[w]);
+    for (size_t k = 0; k < labels.size(); k++)
+      std::cout << std::left << std::setw(12) << std::setprecision(3) << scale * bytes[k] / best[k];
+    std::cout << std::endl;
+  }
+  std::cout << "Aggregate of " << num_procs << " workers, slowest worker per iteration:" << std::endl;
+  std::cout.precision(ss);
+
+  std::ofstream csv_file(csv_filename);
+  Results results = report_timings<T>(timings, num_procs, csv_file, report, timer_overhead);
+  csv_file.close();
+  return results;
+}
+
+#ifdef BABELSTREAM_MPI
+// Print the best bandwidth of every rank on rank 0 and list the ranks falling behind the
+// others. Returns, on rank 0, the time of the slowest rank for every iteration.
+template <typename T>
+std::vector<std::vector<double>> reduce_ranks(const std::vector<std::vector<double>>& timings)
+{
+  const std::vector<std::string> labels = kernel_labels();
+  const std::vector<size_t> bytes = kernel_bytes<T>(ARRAY_SIZE);
+  const double scale = bandwidth_scale();
+  const int kernels = labels.size();
+
+  std::vector<std::vector<double>> slowest(timings.size());
+  for (size_t k = 0; k < timings.size(); k++)
+  {
+    slowest[k].resize(timings[k].size());
+    MPI_Reduce(timings[k].data(), slowest[k].data(), timings[k].size(), MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  }
+
+  // Best bandwidth of each kernel, and the host, of every rank
+  std::vector<double> bandwidth;
+  const std::vector<double> best = best_times(timings);
+  for (int k = 0; k < kernels; k++)
+    bandwidth.push_back(scale * bytes[k] / best[k]);
+  std::vector<double> rank_bandwidth(mpi_rank == 0 ? kernels * mpi_size : 0);
+  MPI_Gather(bandwidth.data(), kernels, MPI_DOUBLE, rank_bandwidth.data(), kernels, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  char name[MPI_MAX_PROCESSOR_NAME] = {};
+  int length;
+  MPI_Get_processor_name(name, &length);
+  std::vector<char> names(mpi_rank == 0 ? MPI_MAX_PROCESSOR_NAME * mpi_size : 0);
+  MPI_Gather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, names.data(), MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+  if (mpi_rank != 0)
+    return timings;
+
+  std::vector<double> median(kernels);
+  for (int k = 0; k < kernels; k++)
+  {
+    std::vector<double> column;
+    for (int r = 0; r < mpi_size; r++)
+      column.push_back(rank_bandwidth[r * kernels + k]);
+    std::sort(column.begin(), column.end());
+    median[k] = mpi_size % 2 ? column[mpi_size / 2] : 0.5 * (column[mpi_size / 2 - 1] + column[mpi_size / 2]);
+  }
+
+  std::streamsize ss = std::cout.precision();
+  std::cout
+    << std::left << std::setw(8) << "Rank"
+    << std::left << std::setw(20) << "Host";
+  for (const std::string& label : labels)
+    std::cout << std::left << std::setw(12) << label;
+  std::cout << "(" << bandwidth_heading() << ")" << std::endl << std::fixed;
+
+  std::ostringstream outliers;
+  outliers << std::fixed << std::setprecision(1);
+  for (int r = 0; r < mpi_size; r++)
+  {
+    const std::string host(&names[r * MPI_MAX_PROCESSOR_NAME]);
+    std::cout
+      << std::left << std::setw(8) << r
+      << std::left << std::setw(20) << host;
+    std::string slow;
+    for (int k = 0; k < kernels; k++)
+    {
+      const double bw = rank_bandwidth[r * kernels + k];
+      std::cout << std::left << std::setw(12) << std::setprecision(3) << bw;
+      if (bw < outlier_fraction * median[k])
+      {
+        std::ostringstream kernel;
+        kernel << std::fixed << std::setprecision(1) << " " << labels[k] << " " << 100.0 * (1.0 - bw / median[k]) << "%";
+        slow += kernel.str();
+      }
+    }
+    std::cout << std::endl;
+    if (!slow.empty())
+      outliers << "  rank " << r << " (" << host << "):" << slow << " below median" << std::endl;
+  }
+
+  std::cout << "Outliers (below " << std::setprecision(0) << 100.0 * outlier_fraction << "% of the median rank):";
+  if (outliers.str().empty())
+    std::cout << " none" << std::endl;
+  else
+    std::cout << std::endl << outliers.str();
+  std::cout << "Aggregate of " << mpi_size << " ranks, slowest rank per iteration:" << std::endl;
+  std::cout.precision(ss);
+
+  return slowest;
+}
+#endif
+
+// Print the average count of every performance counter event per invocation of each
+// kernel, normalised per array element, and write the raw averages to the CSV file
+void report_counters(std::ofstream& csv_file)
+{
+  const std::vector<std::string> labels = kernel_labels();
+  const std::vector<std::string>& events = counters->events();
+
+  // Instructions per cycle, if both were counted
+  const ptrdiff_t cycles = std::find(events.begin(), events.end(), "cycles") - events.begin();
+  const ptrdiff_t instructions = std::find(events.begin(), events.end(), "instructions") - events.begin();
+  const bool ipc = cycles < (ptrdiff_t)events.size() && instructions < (ptrdiff_t)events.size();
+
+  if (output_as_csv)
+  {
+    csv_file
+      << "function" << csv_separator
+      << "event" << csv_separator
+      << "per_invocation" << csv_separator
+      << "per_element" << std::endl;
+  }
+
+  // Per element counts span many orders of magnitude, so print them in general format
+  std::ios::fmtflags flags = std::cout.flags();
+  std::streamsize ss = std::cout.precision();
+  std::cout.unsetf(std::ios::floatfield);
+  std::cout << "Counters (per element):" << std::endl
+    << std::left << std::setw(12) << "Function";
+  for (const std::string& event : events)
+    std::cout << std::left << std::setw(std::max<size_t>(12, event.size() + 2)) << event;
+  if (ipc)
+    std::cout << std::left << std::setw(12) << "IPC";
+  std::cout << std::endl;
+
+  for (size_t k = 0; k < labels.size(); k++)
+  {
+    std::cout << std::left << std::setw(12) << labels[k];
+    for (size_t e = 0; e < events.size(); e++)
+    {
+      const double mean = counters->mean(k, e);
+      if (output_as_csv)
+      {
+        csv_file
+          << labels[k] << csv_separator
+          << events[e] << csv_separator
+          << mean << csv_separator
+          << mean / ARRAY_SIZE << std::endl;
+      }
+      std::cout << std::left << std::setw(std::max<size_t>(12, events[e].size() + 2))
+        << std::setprecision(4) << mean / ARRAY_SIZE;
+    }
+    if (ipc)
+      std::cout << std::left << std::setw(12) << std::setprecision(3)
+        << counters->mean(k, instructions) / counters->mean(k, cycles);
+    std::cout << std::endl;
+  }
+  std::cout.precision(ss);
+  std::cout.flags(flags);
+}
+
+// Rerun the kernels with non-temporal stores and report them after the regular results,
+// followed by the gain of each kernel over its regular bandwidth
+template <typename T>
+void run_nontemporal(Stream<T> *stream, Results& results, std::ofstream& csv_file,
+                     JsonReport *report, double timer_overhead)
+{
+  if (!stream->set_nontemporal(true))
+  {
+    std::cerr << implementation << " cannot write with non-temporal stores in this build" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  nontemporal_pass = true;
+
+  std::cout << std::endl << "Non-temporal stores" << std::endl;
+  stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
+  T sum{};
+  std::vector<std::vector<double>> timings = run_benchmark<T>(stream, sum);
+
+  check_solution<T>(stream, ARRAY_SIZE, num_times + num_warmups, sum);
+
+#ifdef BABELSTREAM_MPI
+  if (mpi_size > 1)
+    timings = reduce_ranks<T>(timings);
+#endif
+
+  Results nt = report_timings<T>(timings, mpi_size, csv_file, report, timer_overhead);
+  stream->set_nontemporal(false);
+  nontemporal_pass = false;
+
+  // Both runs list the same kernels in the same order; the CSV file already has both
+  std::cout << std::endl;
+  ResultTable table({
+    {"", "Function", 12, 0},
+    {"", "Regular", 12, 3},
+    {"", "Non-temporal", 16, 3},
+    {"", "Gain (%)", 12, 1}}, "", csv_separator);
+  const size_t regular = results.size();
+  for (size_t k = 0; k < nt.size() && k < regular; k++)
+    table.row({results[k].first, results[k].second, nt[k].second, 100.0 * (nt[k].second / results[k].second - 1.0)});
+  results.insert(results.end(), nt.begin(), nt.end());
+}
+
+// Generic run routine
+// Runs the kernel(s) and prints output.
+template <typename T>
+Results run()
+{
+  std::streamsize ss = std::cout.precision();
+
+  // Modes that replace the standard benchmark loop
+  const int modes = (soak_duration > 0.0) + sweep + !thread_counts.empty() + (roofline_max >= 0)
+    + !mix_ratios.empty() + (strided_pages > 0) + !index_patterns.empty() + (latency_bytes > 0) + (launch_calls > 0)
+    + index_check;
+  const std::string mode_flags = "--duration, --sweep, --threads-sweep, --roofline, --mix, --strided, --indirect, --latency, --launch, --check-indices";
+  if (modes > 1)
+  {
+    std::cerr << "Only one of " << mode_flags << " can be used at a time" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (modes > 0 && !sweep && thread_counts.empty() && adaptive_width > 0.0)
+  {
+    std::cerr << "--duration, --roofline, --mix, --strided, --indirect, --latency, --launch and --check-indices cannot be combined with --adaptive" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (perf_counters && (num_procs > 0 || modes > 0))
+  {
+    std::cerr << "--counters cannot be combined with --procs, " << mode_flags << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (mpi_size > 1 && (num_procs > 0 || modes > 0 || adaptive_width > 0.0))
+  {
+    // Ranks must run the same number of iterations to meet at the barrier
+    std::cerr << "MPI runs cannot be combined with --procs, " << mode_flags << " or --adaptive" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (nontemporal && (num_procs > 0 || modes > 0))
+  {
+    std::cerr << "--nontemporal cannot be combined with --procs, " << mode_flags << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (inner_reps > 1 && ((modes > 0 && !sweep && thread_counts.empty()) || nontemporal || perf_counters))
+  {
+    // Only the main kernels repeat, and soak windows validate one sweep per iteration
+    std::cerr << "--inner-reps can only be combined with --sweep and --threads-sweep of the modes,"
+      << " and not with --nontemporal or --counters" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (!binding.empty() && (num_procs > 0 || mpi_size > 1))
+  {
+    // Every process would pin its threads to the same CPUs
+    std::cerr << "--bind cannot be combined with --procs or MPI runs, bind the processes instead" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (numa_policy == NumaPolicy::Replicate && num_procs > 0)
+  {
+    // Each worker already has arrays of its own
+    std::cerr << "--numa replicate cannot be combined with --procs" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (num_procs > 0 && (modes > 0 || adaptive_width > 0.0))
+  {
+    // Workers must run the same number of iterations to meet at the barrier
+    std::cerr << "--procs cannot be combined with " << mode_flags << " or --adaptive" << std::endl;
+    exit(EXIT_FAILURE);
+  }
 
-  if (selection == Benchmark::All)
+  if (adaptive_width > 0.0)
+  {
+    std::cout << "Running kernels until the 95% CI is within +/-" << 100.0 * adaptive_width
+      << "% or " << time_budget << " s have passed" << std::endl;
+  }
+  else if (selection == Benchmark::All)
     std::cout << "Running kernels " << num_times << " times" << std::endl;
   else if (selection == Benchmark::Triad)
   {
   std::cout << "Running triad " << num_times << " times" << std::endl;
   std::cout << "Number of elements: " << ARRAY_SIZE << std::endl;
   }
+  if (inner_reps > 1)
+    std::cout << "Sweeping the arrays " << inner_reps << " times per kernel call" << std::endl;
 
 
-  if (sizeof(T) == sizeof(float))
-    std::cout << "Precision: float" << std::endl;
-  else
-    std::cout << "Precision: double" << std::endl;
+  std::cout << "Precision: " << Element<T>::description() << std::endl;
 
 
   if (mibibytes)
@@ -238,107 +2402,157 @@ void run()
   
   std::cout.precision(ss);
 
-  Stream<T> *stream;
-
-#if defined(CUDA)
-  // Use the CUDA implementation
-  stream = new CUDAStream<T>(ARRAY_SIZE, deviceIndex);
+  // Timings are per sweep, and so is the resolution of the timer
+  const double timer_overhead = measureTimerOverhead() / inner_reps;
+  JsonReport *report = nullptr;
+  if (!json_filename.empty())
+    report = new JsonReport(json_filename, json_lines, run_metadata<T>());
 
-#elif defined(HIP)
-  // Use the HIP implementation
-  stream = new HIPStream<T>(ARRAY_SIZE, deviceIndex);
+  if (num_procs > 0)
+  {
+    std::cout << "Running " << num_procs << " processes in lockstep" << std::endl;
+    Results results = run_processes<T>(report, timer_overhead);
+    delete report;
+    return results;
+  }
 
-#elif defined(HC)
-  // Use the HC implementation
-  stream = new HCStream<T>(ARRAY_SIZE, deviceIndex);
+  if (mpi_size > 1)
+    std::cout << "Running on " << mpi_size << " MPI ranks in lockstep" << std::endl;
 
-#elif defined(OCL)
-  // Use the OpenCL implementation
-  stream = new OCLStream<T>(ARRAY_SIZE, deviceIndex);
+  if (bind_requested)
+    report_binding();
 
-#elif defined(USE_RAJA)
-  // Use the RAJA implementation
-  stream = new RAJAStream<T>(ARRAY_SIZE, deviceIndex);
+  // Opened before the stream so that the threads of the model inherit the counters
+  if (perf_counters)
+  {
+    counters = new PerfCounters(kernel_labels().size());
+    if (counters->events().empty())
+      std::cout << "Performance counters unavailable: " << counters->errors() << std::endl;
+    else if (!counters->errors().empty())
+      std::cout << "Performance counters not available: " << counters->errors() << std::endl;
+  }
 
-#elif defined(KOKKOS)
-  // Use the Kokkos implementation
-  stream = new KokkosStream<T>(ARRAY_SIZE, deviceIndex);
+  Stream<T> *stream = create_stream<T>(ARRAY_SIZE);
 
-#elif defined(STD_DATA)
-  // Use the C++ STD data-oriented implementation
-  stream = new STDDataStream<T>(ARRAY_SIZE, deviceIndex);
+  if (soak_duration > 0.0)
+  {
+    std::cout << "Soaking for " << soak_duration << " s in windows of " << soak_window << " iterations" << std::endl;
+    Results results = run_soak<T>(stream);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#elif defined(STD_INDICES)
-  // Use the C++ STD index-oriented implementation
-  stream = new STDIndicesStream<T>(ARRAY_SIZE, deviceIndex);
+  if (!thread_counts.empty())
+  {
+    std::cout << "Sweeping thread counts from " << thread_counts.front() << " to " << thread_counts.back() << std::endl;
+    Results results = run_threads_sweep<T>(stream);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#elif defined(STD_RANGES)
-  // Use the C++ STD ranges implementation
-  stream = new STDRangesStream<T>(ARRAY_SIZE, deviceIndex);
+  if (roofline_max >= 0)
+  {
+    std::cout << "Running the roofline kernel with up to " << roofline_max << " extra multiply-adds per element" << std::endl;
+    Results results = run_roofline<T>(stream);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#elif defined(TBB)
-  // Use the C++20 implementation
-  stream = new TBBStream<T>(ARRAY_SIZE, deviceIndex);
+  if (!mix_ratios.empty())
+  {
+    std::cout << "Running " << mix_ratios.size() << " read:write mix kernel" << (mix_ratios.size() > 1 ? "s" : "") << std::endl;
+    Results results = run_mix<T>(stream);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#elif defined(THRUST)
-  // Use the Thrust implementation
-  stream = new ThrustStream<T>(ARRAY_SIZE, deviceIndex); 
+  if (strided_pages > 0)
+  {
+    std::cout << "Running strided copy and triad with strides up to " << strided_pages << " page" << (strided_pages > 1 ? "s" : "") << std::endl;
+    Results results = run_strided<T>(stream);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#elif defined(ACC)
-  // Use the OpenACC implementation
-  stream = new ACCStream<T>(ARRAY_SIZE, deviceIndex);
+  if (index_check)
+  {
+    std::cout << "Checking 64-bit indices on sparse arrays with strided copy and triad" << std::endl;
+    Results results = run_index_check<T>(stream);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#elif defined(SYCL) || defined(SYCL2020)
-  // Use the SYCL implementation
-  stream = new SYCLStream<T>(ARRAY_SIZE, deviceIndex);
+  if (!index_patterns.empty())
+  {
+    std::cout << "Running gather and scatter with " << index_patterns.size() << " index pattern" << (index_patterns.size() > 1 ? "s" : "") << std::endl;
+    Results results = run_indirect<T>(stream);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#elif defined(OMP)
-  // Use the OpenMP implementation
-  stream = new OMPStream<T>(ARRAY_SIZE, deviceIndex);
+  if (latency_bytes > 0)
+  {
+    std::cout << "Chasing lists of up to " << latency_bytes << " bytes per thread with up to "
+      << latency_chains << " chain" << (latency_chains > 1 ? "s" : "") << std::endl;
+    Results results = run_latency<T>(stream);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#elif defined(FUTHARK)
-  // Use the Futhark implementation
-  stream = new FutharkStream<T>(ARRAY_SIZE, deviceIndex);
+  if (launch_calls > 0)
+  {
+    std::cout << "Timing " << launch_calls << " calls of each kernel on empty arrays and one element per thread" << std::endl;
+    Results results = run_launch<T>(stream, timer_overhead);
+    delete stream;
+    delete report;
+    return results;
+  }
 
-#endif
+  if (sweep)
+  {
+    std::cout << "Sweeping array sizes from " << sweep_min << " to " << ARRAY_SIZE
+      << " elements (factor " << sweep_factor << ")" << std::endl;
+    run_sweep<T>(stream, report, timer_overhead);
+    delete stream;
+    delete report;
+    return Results();
+  }
 
   auto init1 = std::chrono::high_resolution_clock::now();
-  stream->init_arrays(startA, startB, startC);
+  stream->init_arrays(Element<T>::initA(), Element<T>::initB(), Element<T>::initC());
   auto init2 = std::chrono::high_resolution_clock::now();
 
   // Result of the Dot kernel, if used.
   T sum{};
 
-  std::vector<std::vector<double>> timings;
-
-  switch (selection)
-  {
-    case Benchmark::All:
-      timings = run_all<T>(stream, sum);
-      break;
-    case Benchmark::Triad:
-      timings = run_triad<T>(stream);
-      break;
-    case Benchmark::Nstream:
-      timings = run_nstream<T>(stream);
-      break;
-  };
+  std::vector<std::vector<double>> timings = run_benchmark<T>(stream, sum);
 
-  // Check solutions
-  // Create host vectors
-  std::vector<T> a(ARRAY_SIZE);
-  std::vector<T> b(ARRAY_SIZE);
-  std::vector<T> c(ARRAY_SIZE);
+  if (corrupt_arrays)
+    stream->init_arrays(T{}, T{}, T{});
 
+  // Check solutions, in place where the model can validate its arrays, so that no second
+  // copy of them is needed; otherwise on a copy read back to the host
+  T goldA, goldB, goldC;
+  gold_values<T>(num_times + num_warmups, goldA, goldB, goldC);
+  double errA, errB, errC;
 
   auto read1 = std::chrono::high_resolution_clock::now();
-  stream->read_arrays(a, b, c);
+  const bool in_place = array_errors(stream, ARRAY_SIZE, goldA, goldB, goldC, errA, errB, errC);
   auto read2 = std::chrono::high_resolution_clock::now();
+  const char *read_phase = in_place ? "Validate" : "Read";
 
-  auto initElapsedS = std::chrono::duration_cast<std::chrono::duration<double>>(read2 - read1).count();
-  auto readElapsedS = std::chrono::duration_cast<std::chrono::duration<double>>(init2 - init1).count();
-  auto initBWps = ((mibibytes ? std::pow(2.0, -20.0) : 1.0E-6) * (3 * sizeof(T) * ARRAY_SIZE)) / initElapsedS;
-  auto readBWps = ((mibibytes ? std::pow(2.0, -20.0) : 1.0E-6) * (3 * sizeof(T) * ARRAY_SIZE)) / readElapsedS;
+  auto initElapsedS = std::chrono::duration_cast<std::chrono::duration<double>>(init2 - init1).count();
+  auto readElapsedS = std::chrono::duration_cast<std::chrono::duration<double>>(read2 - read1).count();
+  auto initBWps = (bandwidth_scale() * (3 * sizeof(T) * ARRAY_SIZE)) / initElapsedS;
+  auto readBWps = (bandwidth_scale() * (3 * sizeof(T) * ARRAY_SIZE)) / readElapsedS;
 
   std::ofstream csv_file(csv_filename);
   
@@ -348,7 +2562,7 @@ void run()
       << "phase" << csv_separator
       << "n_elements" << csv_separator
       << "sizeof" << csv_separator
-      << ((mibibytes) ? "max_mibytes_per_sec" : "max_mbytes_per_sec") << csv_separator
+      << bandwidth_csv("max") << csv_separator
       << "runtime" << std::endl;
     csv_file
       << "Init" << csv_separator
@@ -357,7 +2571,7 @@ void run()
       << initBWps << csv_separator
       << initElapsedS << std::endl;
     csv_file
-      << "Read" << csv_separator
+      << read_phase << csv_separator
       << ARRAY_SIZE << csv_separator
       << sizeof(T) << csv_separator
       << readBWps << csv_separator
@@ -369,148 +2583,56 @@ void run()
     << initElapsedS
     << " s (="
     << initBWps
-    << (mibibytes ? " MiBytes/sec" : " MBytes/sec")
+    << " " << bandwidth_heading()
     << ")" << std::endl;
-  std::cout << "Read: "
+  std::cout << read_phase << ": "
     << std::setw(7)
     << readElapsedS
     << " s (="
     << readBWps
-    << (mibibytes ? " MiBytes/sec" : " MBytes/sec")
+    << " " << bandwidth_heading()
     << ")" << std::endl;
+  report_pages();
+
+  check_solution<T>(ARRAY_SIZE, num_times + num_warmups, errA, errB, errC, sum);
 
-  check_solution<T>(num_times + num_warmups, a, b, c, sum);
+#ifdef BABELSTREAM_MPI
+  if (mpi_size > 1)
+    timings = reduce_ranks<T>(timings);
+#endif
 
   // Display timing results
-  if (output_as_csv)
-  {
-    csv_file
-      << "function" << csv_separator
-      << "num_times" << csv_separator
-      << "n_elements" << csv_separator
-      << "sizeof" << csv_separator
-      << ((mibibytes) ? "max_mibytes_per_sec" : "max_mbytes_per_sec") << csv_separator
-      << "min_runtime" << csv_separator
-      << "max_runtime" << csv_separator
-      << "avg_runtime" << std::endl;
-  }
-  std::cout
-    << std::left << std::setw(12) << "Function"
-    << std::left << std::setw(12) << ((mibibytes) ? "MiBytes/sec" : "MBytes/sec")
-    << std::left << std::setw(12) << "Min (sec)"
-    << std::left << std::setw(12) << "Max"
-    << std::left << std::setw(12) << "Average"
-    << std::endl
-    << std::fixed;
+  Results results = report_timings<T>(timings, mpi_size, csv_file, report, timer_overhead);
 
-  if (selection == Benchmark::All || selection == Benchmark::Nstream)
+  if (counters)
   {
-
-    std::vector<std::string> labels;
-    std::vector<size_t> sizes;
-
-    if (selection == Benchmark::All)
-    {
-      labels = {"Copy", "Mul", "Add", "Triad", "Dot"};
-      sizes = {
-        2 * sizeof(T) * ARRAY_SIZE,
-        2 * sizeof(T) * ARRAY_SIZE,
-        3 * sizeof(T) * ARRAY_SIZE,
-        3 * sizeof(T) * ARRAY_SIZE,
-        2 * sizeof(T) * ARRAY_SIZE};
-    } else if (selection == Benchmark::Nstream)
-    {
-      labels = {"Nstream"};
-      sizes = {4 * sizeof(T) * ARRAY_SIZE };
-    }
-
-    for (int i = 0; i < timings.size(); ++i)
-    {
-      // Get min/max; ignore warmup iterations
-      auto minmax = std::minmax_element(timings[i].begin() + num_warmups, timings[i].end());
-
-      // Calculate average; ignore warmup iterations
-      double average = std::accumulate(timings[i].begin() + num_warmups, timings[i].end(), 0.0) / (double)(num_times);
-
-      // Display results
-      if (output_as_csv)
-      {
-        csv_file
-          << labels[i] << csv_separator
-          << num_times << csv_separator
-          << ARRAY_SIZE << csv_separator
-          << sizeof(T) << csv_separator
-          << ((mibibytes) ? std::pow(2.0, -20.0) : 1.0E-6) * sizes[i] / (*minmax.first) << csv_separator
-          << *minmax.first << csv_separator
-          << *minmax.second << csv_separator
-          << average
-          << std::endl;
-      }
-      
-      std::cout
-        << std::left << std::setw(12) << labels[i]
-        << std::left << std::setw(12) << std::setprecision(3) << 
-        ((mibibytes) ? std::pow(2.0, -20.0) : 1.0E-6) * sizes[i] / (*minmax.first)
-        << std::left << std::setw(12) << std::setprecision(5) << *minmax.first
-        << std::left << std::setw(12) << std::setprecision(5) << *minmax.second
-        << std::left << std::setw(12) << std::setprecision(5) << average
-        << std::endl;
-    }
-  } else if (selection == Benchmark::Triad)
-  {
-    // Display timing results
-    double total_bytes = 3 * sizeof(T) * ARRAY_SIZE * num_times;
-    double bandwidth = ((mibibytes) ? std::pow(2.0, -30.0) : 1.0E-9) * (total_bytes / timings[0][0]);
-
-    if (output_as_csv)
-    {
-      csv_file
-        << "function" << csv_separator
-        << "num_times" << csv_separator
-        << "n_elements" << csv_separator
-        << "sizeof" << csv_separator
-        << ((mibibytes) ? "gibytes_per_sec" : "gbytes_per_sec") << csv_separator
-        << "runtime"
-        << std::endl;
-      csv_file
-        << "Triad" << csv_separator
-        << num_times << csv_separator
-        << ARRAY_SIZE << csv_separator
-        << sizeof(T) << csv_separator
-        << bandwidth << csv_separator
-        << timings[0][0]
-        << std::endl;
-    }
-    else
-    {
-      std::cout
-        << "--------------------------------"
-        << std::endl << std::fixed
-        << "Runtime (seconds): " << std::left << std::setprecision(5)
-        << timings[0][0] << std::endl
-        << "Bandwidth (" << ((mibibytes) ? "GiB/s" : "GB/s") << "):  "
-        << std::left << std::setprecision(3)
-        << bandwidth << std::endl;
-    }
+    if (!counters->events().empty())
+      report_counters(csv_file);
+    delete counters;
+    counters = nullptr;
   }
 
+  if (nontemporal)
+    run_nontemporal<T>(stream, results, csv_file, report, timer_overhead);
+
   csv_file.close();
 
+  delete report;
   delete stream;
 
+  return results;
+
 }
 
 
 template <typename T>
-void check_solution(const unsigned int ntimes, std::vector<T>& a, std::vector<T>& b, std::vector<T>& c, T& sum)
+void gold_values(const unsigned int ntimes, T& goldA, T& goldB, T& goldC)
 {
-  // Generate correct solution
-  T goldA = startA;
-  T goldB = startB;
-  T goldC = startC;
-  T goldSum{};
+  goldA = Element<T>::initA();
+  goldB = Element<T>::initB();
+  goldC = Element<T>::initC();
 
-  const T scalar = startScalar;
+  const T scalar = Element<T>::scalar();
 
   for (unsigned int i = 0; i < ntimes; i++)
   {
@@ -526,42 +2648,63 @@ void check_solution(const unsigned int ntimes, std::vector<T>& a, std::vector<T>
       goldA = goldB + scalar * goldC;
     } else if (selection == Benchmark::Nstream)
     {
-      goldA += goldB + scalar * goldC;
+      for (unsigned int rep = 0; rep < inner_reps; rep++)
+        goldA += goldB + scalar * goldC;
     }
   }
+}
+
+// Check the arrays of a stream after ntimes iterations of the benchmark, and the sum of
+// its last dot product
+template <typename T>
+void check_solution(Stream<T> *stream, intptr_t array_size, const unsigned int ntimes, T& sum)
+{
+  T goldA, goldB, goldC;
+  gold_values<T>(ntimes, goldA, goldB, goldC);
+  double errA, errB, errC;
+  array_errors(stream, array_size, goldA, goldB, goldC, errA, errB, errC);
+  check_solution<T>(array_size, ntimes, errA, errB, errC, sum);
+}
+
+// Report the average errors of arrays of array_size elements after ntimes iterations, see
+// array_errors, and check the sum of the last dot product
+template <typename T>
+void check_solution(intptr_t array_size, const unsigned int ntimes, double errA, double errB, double errC, T& sum)
+{
+  // Generate correct solution
+  T goldA, goldB, goldC;
 
-  // Do the reduction
-  goldSum = goldA * goldB * ARRAY_SIZE;
+  gold_values<T>(ntimes, goldA, goldB, goldC);
 
-  // Calculate the average error
-  long double errA = std::accumulate(a.begin(), a.end(), T{}, [&](double sum, const T val){ return sum + std::fabs(val - goldA); });
-  errA /= a.size();
-  long double errB = std::accumulate(b.begin(), b.end(), T{}, [&](double sum, const T val){ return sum + std::fabs(val - goldB); });
-  errB /= b.size();
-  long double errC = std::accumulate(c.begin(), c.end(), T{}, [&](double sum, const T val){ return sum + std::fabs(val - goldC); });
-  errC /= c.size();
-  long double errSum = std::fabs((sum - goldSum)/goldSum);
+  // Do the reduction, wide enough not to round or overflow
+  typedef typename Element<T>::Wide Wide;
+  const Wide goldSum = Wide(goldA) * Wide(goldB) * (long double)array_size;
 
-  long double epsi = std::numeric_limits<T>::epsilon() * 100.0;
+  long double errSum = element_abs((Wide(sum) - goldSum)/goldSum);
 
-  if (errA > epsi)
+  if (errA > error_tolerance(goldA))
     std::cerr
       << "Validation failed on a[]. Average error " << errA
       << std::endl;
-  if (errB > epsi)
+  if (errB > error_tolerance(goldB))
     std::cerr
       << "Validation failed on b[]. Average error " << errB
       << std::endl;
-  if (errC > epsi)
+  if (errC > error_tolerance(goldC))
     std::cerr
       << "Validation failed on c[]. Average error " << errC
       << std::endl;
-  // Check sum to 8 decimal places
-  if (selection == Benchmark::All && errSum > 1.0E-8)
+  // Check sum to 8 decimal places. 16-bit dot products accumulate in Element<T>::Sum and
+  // only round to T at the end, so allow them the one rounding.
+  const long double sumTolerance = sizeof(T) == 2 ? Element<T>::epsilon() : 1.0E-8L;
+  if (selection == Benchmark::All && element_abs(goldSum) > Element<T>::max())
+    std::cout
+      << "Sum not checked: " << Element<T>::description() << " cannot hold it" << std::endl;
+  else if (selection == Benchmark::All && errSum > sumTolerance)
     std::cerr
       << "Validation failed on sum. Error " << errSum
       << std::endl << std::setprecision(15)
-      << "Sum was " << sum << " but should be " << goldSum
+      << "Sum was " << Wide(sum) << " but should be " << goldSum
       << std::endl;
 
 }
@@ -573,10 +2716,109 @@ int parseUInt(const char *str, unsigned int *output)
   return !strlen(next);
 }
 
-int parseInt(const char *str, int *output)
+int parseInt(const char *str, intptr_t *output)
+{
+  char *next;
+  *output = strtoll(str, &next, 10);
+  return !strlen(next);
+}
+
+// Parse a number of bytes with an optional K, M or G suffix (powers of 1024)
+int parseBytes(const char *str, size_t *output)
+{
+  char *next;
+  *output = strtoull(str, &next, 10);
+  switch (*next)
+  {
+    case 'K': *output <<= 10; next++; break;
+    case 'M': *output <<= 20; next++; break;
+    case 'G': *output <<= 30; next++; break;
+  }
+  return next != str && !strlen(next);
+}
+
+// Parse thread counts given as a list (1-4,8,16) or as MIN:MAX:STEP
+int parseThreadCounts(const char *str, std::vector<int>& counts)
+{
+  counts.clear();
+  if (strchr(str, ':'))
+  {
+    char *next;
+    long min = strtol(str, &next, 10);
+    if (*next != ':')
+      return 0;
+    long max = strtol(next + 1, &next, 10);
+    if (*next != ':')
+      return 0;
+    long step = strtol(next + 1, &next, 10);
+    if (strlen(next) || min < 1 || max < min || step < 1)
+      return 0;
+    for (long n = min; n <= max; n += step)
+      counts.push_back(static_cast<int>(n));
+  }
+  else
+  {
+    counts = parseCpuList(str);
+  }
+  std::sort(counts.begin(), counts.end());
+  counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+  return !counts.empty() && counts.front() >= 1;
+}
+
+// Parse colon-separated CPU lists, one per worker process, e.g. 0-3:4-7
+int parseProcCpus(const char *str, std::vector<std::vector<int>>& cpus)
+{
+  cpus.clear();
+  std::stringstream ss(str);
+  std::string list;
+  while (std::getline(ss, list, ':'))
+  {
+    cpus.push_back(parseCpuList(list));
+    if (cpus.back().empty())
+      return 0;
+  }
+  return !cpus.empty();
+}
+
+// Parse comma-separated R:W pairs, e.g. 1:0,0:1,2:1, or "all" for every supported pair
+int parseMixRatios(const char *str, std::vector<std::pair<unsigned int, unsigned int>>& ratios)
+{
+  ratios.clear();
+  if (!std::string("all").compare(str))
+  {
+    for (unsigned int r = 0; r <= MIX_MAX_READS; r++)
+      for (unsigned int w = 0; w <= MIX_MAX_WRITES; w++)
+        if (mix_supported(r, w))
+          ratios.push_back(std::make_pair(r, w));
+    return 1;
+  }
+  std::stringstream ss(str);
+  std::string pair;
+  while (std::getline(ss, pair, ','))
+  {
+    char *next;
+    long reads = strtol(pair.c_str(), &next, 10);
+    if (*next != ':' || reads < 0)
+      return 0;
+    long writes = strtol(next + 1, &next, 10);
+    if (*next != '\0' || writes < 0 || !mix_supported(reads, writes))
+      return 0;
+    ratios.push_back(std::make_pair(reads, writes));
+  }
+  return !ratios.empty();
+}
+
+// Parse MIN:MAX:FACTOR
+int parseSweep(const char *str, intptr_t *min, intptr_t *max, double *factor)
 {
   char *next;
-  *output = strtol(str, &next, 10);
+  *min = strtoll(str, &next, 10);
+  if (*next != ':')
+    return 0;
+  *max = strtoll(next + 1, &next, 10);
+  if (*next != ':')
+    return 0;
+  *factor = strtod(next + 1, &next);
   return !strlen(next);
 }
 
@@ -586,9 +2828,23 @@ void parseArguments(int argc, char *argv[])
   {
     if (!std::string("--list").compare(argv[i]))
     {
-      listDevices();
-      exit(EXIT_SUCCESS);
+      list_devices = true;
+    }
+#ifdef BABELSTREAM_PLUGINS
+    else if (!std::string("--model").compare(argv[i]))
+    {
+      if (++i >= argc)
+      {
+        std::cerr << "No model provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      std::stringstream ss(argv[i]);
+      std::string model;
+      while (std::getline(ss, model, ','))
+        if (!model.empty())
+          models.push_back(model);
     }
+#endif
     else if (!std::string("--device").compare(argv[i]))
     {
       if (++i >= argc || !parseUInt(argv[i], &deviceIndex))
@@ -620,9 +2876,223 @@ void parseArguments(int argc, char *argv[])
         exit(EXIT_FAILURE);
       }
     }
+    else if (!std::string("--sweep").compare(argv[i]))
+    {
+      if (++i >= argc || !parseSweep(argv[i], &sweep_min, &ARRAY_SIZE, &sweep_factor) ||
+          sweep_min <= 0 || ARRAY_SIZE < sweep_min || sweep_factor <= 1.0)
+      {
+        std::cerr << "Invalid sweep, expected MIN:MAX:FACTOR with 0 < MIN <= MAX and FACTOR > 1." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      sweep = true;
+    }
+    else if (!std::string("--adaptive").compare(argv[i]))
+    {
+      char *next = nullptr;
+      if (++i < argc)
+        adaptive_width = strtod(argv[i], &next);
+      if (!next || strlen(next) || adaptive_width <= 0.0)
+      {
+        std::cerr << "Invalid adaptive width, expected a positive fraction such as 0.01." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--time-budget").compare(argv[i]))
+    {
+      char *next = nullptr;
+      if (++i < argc)
+        time_budget = strtod(argv[i], &next);
+      if (!next || strlen(next) || time_budget <= 0.0)
+      {
+        std::cerr << "Invalid time budget." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--duration").compare(argv[i]))
+    {
+      char *next = nullptr;
+      if (++i < argc)
+        soak_duration = strtod(argv[i], &next);
+      if (!next || strlen(next) || soak_duration <= 0.0)
+      {
+        std::cerr << "Invalid duration." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--window").compare(argv[i]))
+    {
+      if (++i >= argc || !parseUInt(argv[i], &soak_window) || soak_window < 1)
+      {
+        std::cerr << "Invalid window size." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--threads-sweep").compare(argv[i]))
+    {
+      if (++i >= argc || !parseThreadCounts(argv[i], thread_counts))
+      {
+        std::cerr << "Invalid thread counts, expected a list such as 1-8,16 or MIN:MAX:STEP." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--procs").compare(argv[i]))
+    {
+      if (++i >= argc || !parseUInt(argv[i], &num_procs) || num_procs < 1)
+      {
+        std::cerr << "Invalid number of processes." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--proc-bind").compare(argv[i]))
+    {
+      if (++i >= argc)
+      {
+        std::cerr << "No binding provided for --proc-bind" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      proc_bind_numa = !std::string("numa").compare(argv[i]);
+      proc_cpus.clear();
+      if (!proc_bind_numa && std::string("none").compare(argv[i]) && !parseProcCpus(argv[i], proc_cpus))
+      {
+        std::cerr << "Invalid binding, expected none, numa or CPU lists such as 0-3:4-7." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--bind").compare(argv[i]))
+    {
+      if (++i >= argc || !parseBindPolicy(argv[i], bind_policy, bind_list))
+      {
+        std::cerr << "Invalid binding, expected none, compact, scatter, numa or list:CPUS." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      bind_requested = true;
+    }
+    else if (!std::string("--smt").compare(argv[i]))
+    {
+      if (++i >= argc || (std::string("on").compare(argv[i]) && std::string("off").compare(argv[i])))
+      {
+        std::cerr << "Invalid SMT setting, expected on or off." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      bind_smt = !std::string("on").compare(argv[i]);
+    }
+    else if (!std::string("--roofline").compare(argv[i]))
+    {
+      unsigned int max;
+      if (++i >= argc || !parseUInt(argv[i], &max))
+      {
+        std::cerr << "Invalid number of multiply-adds." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      roofline_max = std::min<unsigned int>(max, std::numeric_limits<int>::max());
+    }
+    else if (!std::string("--mix").compare(argv[i]))
+    {
+      if (++i >= argc || !parseMixRatios(argv[i], mix_ratios))
+      {
+        std::cerr << "Invalid mix, expected all or R:W pairs such as 1:0,0:1,2:1 with up to "
+          << MIX_MAX_READS << " reads and " << MIX_MAX_WRITES << " writes." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--strided").compare(argv[i]))
+    {
+      if (++i >= argc || !parseUInt(argv[i], &strided_pages) || strided_pages < 1)
+      {
+        std::cerr << "Invalid number of pages." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--latency").compare(argv[i]))
+    {
+      if (++i >= argc || !parseBytes(argv[i], &latency_bytes) || latency_bytes < 4096)
+      {
+        std::cerr << "Invalid list size, expected at least 4K." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--chains").compare(argv[i]))
+    {
+      if (++i >= argc || !parseUInt(argv[i], &latency_chains) || latency_chains < 1 || latency_chains > CHASE_MAX_CHAINS)
+      {
+        std::cerr << "Invalid number of chains, expected 1 to " << CHASE_MAX_CHAINS << "." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--launch").compare(argv[i]))
+    {
+      if (++i >= argc || !parseUInt(argv[i], &launch_calls) || launch_calls < 1)
+      {
+        std::cerr << "Invalid number of calls." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--inner-reps").compare(argv[i]))
+    {
+      if (++i >= argc || !parseUInt(argv[i], &inner_reps) || inner_reps < 1)
+      {
+        std::cerr << "Invalid number of inner repetitions." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--indirect").compare(argv[i]))
+    {
+      if (++i >= argc || (index_patterns = parseIndexPatterns(argv[i])).empty())
+      {
+        std::cerr << "Invalid index patterns, expected all or a list of identity, block[:SIZE], random and window[:SIZE]." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--nontemporal").compare(argv[i]))
+    {
+      nontemporal = true;
+    }
+    else if (!std::string("--check-indices").compare(argv[i]))
+    {
+      if (INTPTR_MAX < large_array_size)
+      {
+        std::cerr << "--check-indices needs a 64-bit build" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      index_check = true;
+    }
+    else if (!std::string("--corrupt").compare(argv[i]))
+    {
+      corrupt_arrays = true;
+    }
+    else if (!std::string("--pages").compare(argv[i]))
+    {
+      if (++i >= argc || !parsePageMode(argv[i], page_mode))
+      {
+        std::cerr << "Invalid page mode, expected default, thp, hugetlb-2m, hugetlb-1g, none or sparse." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--numa").compare(argv[i]))
+    {
+      if (++i >= argc || !parseNumaPolicy(argv[i], numa_policy, numa_node))
+      {
+        std::cerr << "Invalid NUMA policy, expected local, interleave, bind:N or replicate." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (!std::string("--counters").compare(argv[i]))
+    {
+      perf_counters = true;
+    }
     else if (!std::string("--float").compare(argv[i]))
     {
-      use_float = true;
+      element_types = {ElementType::F32};
+      all_types = false;
+    }
+    else if (!std::string("--type").compare(argv[i]))
+    {
+      if (++i >= argc || !parseElementTypes(argv[i], element_types))
+      {
+        std::cerr << "Invalid element types, expected a list of f16, bf16, f32, f64, i32, i64, c32, c64, or all." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      all_types = !std::string("all").compare(argv[i]);
     }
     else if (!std::string("--triad-only").compare(argv[i]))
     {
@@ -641,6 +3111,16 @@ void parseArguments(int argc, char *argv[])
       }
       csv_filename = argv[i];
     }
+    else if (!std::string("--json").compare(argv[i]) ||
+             !std::string("--ndjson").compare(argv[i]))
+    {
+      json_lines = !std::string("--ndjson").compare(argv[i]);
+      if (++i >= argc) {
+        std::cerr << "No path provided for json file" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      json_filename = argv[i];
+    }
     else if (!std::string("--mibibytes").compare(argv[i]))
     {
       mibibytes = true;
@@ -662,13 +3142,65 @@ void parseArguments(int argc, char *argv[])
       std::cout << "Options:" << std::endl;
       std::cout << "  -h  --help               Print the message" << std::endl;
       std::cout << "      --list               List available devices" << std::endl;
+#ifdef BABELSTREAM_PLUGINS
+      std::cout << "      --model      NAMES   Comma-separated models to load and compare, e.g. omp,tbb" << std::endl;
+#endif
       std::cout << "      --device     INDEX   Select device at INDEX" << std::endl;
       std::cout << "  -s  --arraysize  SIZE    Use SIZE elements in the array" << std::endl;
       std::cout << "  -n  --numtimes   NUM     Run the test NUM times (NUM >= 2)" << std::endl;
+      std::cout << "      --sweep      MIN:MAX:FACTOR" << std::endl;
+      std::cout << "                           Run for array sizes MIN, MIN*FACTOR, ... up to MAX elements" << std::endl;
+      std::cout << "      --adaptive   WIDTH   Choose warmup and timed iterations automatically, stopping when the" << std::endl;
+      std::cout << "                           95% CI of every kernel is within +/-WIDTH (e.g. 0.01) of its mean" << std::endl;
+      std::cout << "      --time-budget SECS   Stop adaptive runs after SECS seconds (default 60)" << std::endl;
+      std::cout << "      --duration   SECS    Soak: run for SECS seconds, reporting bandwidth and validating" << std::endl;
+      std::cout << "                           the arrays every window of iterations" << std::endl;
+      std::cout << "      --window     NUM     Iterations per soak window (default 10)" << std::endl;
+      std::cout << "      --threads-sweep LIST Rerun at each thread count in LIST (e.g. 1-8,16 or 1:64:4) and report" << std::endl;
+      std::cout << "                           scaling and the fewest threads reaching 95% of peak bandwidth" << std::endl;
+      std::cout << "      --procs      NUM     Fork NUM processes that run the kernels in lockstep on their own" << std::endl;
+      std::cout << "                           arrays and report the aggregate bandwidth" << std::endl;
+      std::cout << "      --proc-bind  BIND    Bind the processes to none (default), one NUMA node each (numa)," << std::endl;
+      std::cout << "                           or one colon-separated CPU list each, e.g. 0-3:4-7" << std::endl;
+      std::cout << "      --bind       BIND    Pin the threads of the model: none (default), compact, scatter over" << std::endl;
+      std::cout << "                           NUMA nodes and L3 domains, numa (even blocks per node), or" << std::endl;
+      std::cout << "                           list:CPUS in thread order, e.g. list:0-3,8; prints the host topology" << std::endl;
+      std::cout << "      --smt        on|off  Whether --bind uses every hardware thread of a core (default off)" << std::endl;
+      std::cout << "      --roofline   MAX     Run triad with 0, 1, 2, 4, ... up to MAX extra dependent multiply-adds" << std::endl;
+      std::cout << "                           per element and report where it turns compute bound" << std::endl;
+      std::cout << "      --mix        LIST    Run kernels reading R arrays and writing W arrays for each R:W pair" << std::endl;
+      std::cout << "                           in LIST (e.g. 1:0,0:1,7:1), or all pairs up to 8:4" << std::endl;
+      std::cout << "      --strided    PAGES   Run copy and triad over every S-th element for S = 1, 2, 4, ... up to" << std::endl;
+      std::cout << "                           PAGES pages apart, reporting useful and cache line bandwidth" << std::endl;
+      std::cout << "      --indirect   LIST    Run gather and scatter through each index pattern in LIST: identity," << std::endl;
+      std::cout << "                           block[:SIZE], random, window[:SIZE], or all" << std::endl;
+      std::cout << "      --latency    SIZE    Chase randomly linked lists of 4K, 8K, ... up to SIZE (e.g. 1G) per" << std::endl;
+      std::cout << "                           thread, reporting ns per load and misses in flight per thread" << std::endl;
+      std::cout << "      --chains     NUM     Chase 1, 2, 4, ... up to NUM independent chains per thread (default 1)" << std::endl;
+      std::cout << "      --launch     CALLS   Time CALLS calls of each kernel on empty arrays and on one element" << std::endl;
+      std::cout << "                           per thread, reporting the launch overhead in us with percentiles" << std::endl;
+      std::cout << "      --check-indices      Run strided copy and triad on sparse arrays of 2^31 + 1024 elements" << std::endl;
+      std::cout << "                           to check 64-bit indices without the memory of a full run" << std::endl;
+      std::cout << "      --corrupt            Zero the arrays before validating them, to test that validation fails" << std::endl;
+      std::cout << "      --inner-reps NUM     Sweep the arrays NUM times within each kernel call, each thread" << std::endl;
+      std::cout << "                           repeating its own part, to measure cache bandwidth (default 1)" << std::endl;
+      std::cout << "      --nontemporal        Rerun the kernels writing with non-temporal stores and compare" << std::endl;
+      std::cout << "      --pages      MODE    Back the arrays with default, thp (madvise), hugetlb-2m, hugetlb-1g" << std::endl;
+      std::cout << "                           or none (no huge pages) pages, for models on the host; sparse" << std::endl;
+      std::cout << "                           maps them without reserving memory, with no huge pages" << std::endl;
+      std::cout << "      --numa       POLICY  Place the arrays of models on the host by first touch (local, default)," << std::endl;
+      std::cout << "                           interleaved over all nodes, on node N (bind:N), or replicated so" << std::endl;
+      std::cout << "                           the threads of each node have their own (replicate)" << std::endl;
+      std::cout << "      --counters           Count cycles, instructions, LLC, dTLB and DRAM events per kernel" << std::endl;
+      std::cout << "                           with perf_event_open (Linux)" << std::endl;
       std::cout << "      --float              Use floats (rather than doubles)" << std::endl;
+      std::cout << "      --type       LIST    Run on each element type in LIST: f16, bf16, f32, f64, i32, i64," << std::endl;
+      std::cout << "                           c32, c64 (complex), or all that the model is built for" << std::endl;
       std::cout << "      --triad-only         Only run triad" << std::endl;
       std::cout << "      --nstream-only       Only run nstream" << std::endl;
       std::cout << "      --csv        PATH    Output as csv table" << std::endl;
+      std::cout << "      --json       PATH    Write per-iteration samples and statistics as JSON" << std::endl;
+      std::cout << "      --ndjson     PATH    Append one JSON line per result to PATH" << std::endl;
       std::cout << "  -w  --warmups    WARMUPS Run the test WARMUPS time before bandwith calculation" << std::endl;
       std::cout << "      --mibibytes          Use MiB=2^20 for bandwidth calculation (default MB=10^6)" << std::endl;
       std::cout << std::endl;
@@ -681,4 +3213,11 @@ void parseArguments(int argc, char *argv[])
       exit(EXIT_FAILURE);
     }
   }
+
+  if (index_check)
+  {
+    // Only the pages the check touches are backed by memory
+    ARRAY_SIZE = large_array_size;
+    page_mode = PageMode::Sparse;
+  }
 }
@@ -5,22 +5,107 @@
 // For full license terms please see the LICENSE file distributed with this
 // source code
 
-#include <cstdlib>  // For aligned_alloc
+#include <atomic>
+#include <cmath>
 #include "OMPStream.h"
+#include "Affinity.h"
+#include "PageAllocator.h"
 
-#ifndef ALIGNMENT
-#define ALIGNMENT (2*1024*1024) // 2MB
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
 #endif
 
 template <class T>
-OMPStream<T>::OMPStream(const int ARRAY_SIZE, int device)
+static T *alloc_host(size_t n)
+{
+  return allocArray<T>(n);
+}
+
+template <class T>
+static void free_host(T *p)
+{
+  freePages(p);
+}
+
+// Non-temporal stores of one vector of elements from an aligned buffer. They bypass the
+// caches, so the line written is not read first, and are weakly ordered, so each thread
+// must fence before the kernel ends.
+#if defined(__AVX__)
+#define NT_VECTOR_BYTES 32
+static inline void stream_vector(double *p, const double *v) { _mm256_stream_pd(p, _mm256_load_pd(v)); }
+static inline void stream_vector(float *p, const float *v) { _mm256_stream_ps(p, _mm256_load_ps(v)); }
+template <class T>
+static inline void stream_vector(T *p, const T *v)
+{
+  _mm256_stream_si256(reinterpret_cast<__m256i *>(p), _mm256_load_si256(reinterpret_cast<const __m256i *>(v)));
+}
+static inline void stream_fence() { _mm_sfence(); }
+#elif defined(__SSE2__)
+#define NT_VECTOR_BYTES 16
+static inline void stream_vector(double *p, const double *v) { _mm_stream_pd(p, _mm_load_pd(v)); }
+static inline void stream_vector(float *p, const float *v) { _mm_stream_ps(p, _mm_load_ps(v)); }
+template <class T>
+static inline void stream_vector(T *p, const T *v)
+{
+  _mm_stream_si128(reinterpret_cast<__m128i *>(p), _mm_load_si128(reinterpret_cast<const __m128i *>(v)));
+}
+static inline void stream_fence() { _mm_sfence(); }
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_nontemporal_store)
+// Clang lowers this to the target's non-temporal store, e.g. STNP on AArch64
+#define NT_VECTOR_BYTES 16
+template <class T>
+static inline void stream_vector(T *p, const T *v)
+{
+  for (size_t l = 0; l < NT_VECTOR_BYTES / sizeof(T); l++)
+    __builtin_nontemporal_store(v[l], p + l);
+}
+static inline void stream_fence() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+#endif
+#endif
+
+#ifdef STREAM_EXTRA_TYPES
+// OpenMP reduces only arithmetic types by itself
+#pragma omp declare reduction(+ : bfloat16, std::complex<float>, std::complex<double> : omp_out += omp_in)
+#endif
+
+#ifdef NT_VECTOR_BYTES
+// out[i] = value(i) for all i < n with non-temporal stores, where out is aligned to a vector
+template <class T, class F>
+static void stream_kernel(T *out, intptr_t n, F value)
+{
+  const intptr_t lanes = NT_VECTOR_BYTES / sizeof(T);
+  const intptr_t vectors = n / lanes;
+
+  #pragma omp parallel
+  {
+    #pragma omp for nowait
+    for (intptr_t v = 0; v < vectors; v++)
+    {
+      alignas(NT_VECTOR_BYTES) T buffer[NT_VECTOR_BYTES / sizeof(T)];
+      for (intptr_t l = 0; l < lanes; l++)
+        buffer[l] = value(v * lanes + l);
+      stream_vector(out + v * lanes, buffer);
+    }
+    stream_fence();
+  }
+  for (intptr_t i = vectors * lanes; i < n; i++)
+    out[i] = value(i);
+}
+#endif
+
+template <class T>
+OMPStream<T>::OMPStream(const intptr_t ARRAY_SIZE, int device)
+  : mix_arrays(alloc_host<T>, free_host<T>), idx(nullptr), nontemporal(false), inner_reps(1), chase_end(0)
 {
   array_size = ARRAY_SIZE;
 
   // Allocate on the host
-  this->a = (T*)aligned_alloc(ALIGNMENT, sizeof(T)*array_size);
-  this->b = (T*)aligned_alloc(ALIGNMENT, sizeof(T)*array_size);
-  this->c = (T*)aligned_alloc(ALIGNMENT, sizeof(T)*array_size);
+  this->a = alloc_host<T>(array_size);
+  this->b = alloc_host<T>(array_size);
+  this->c = alloc_host<T>(array_size);
 
 #ifdef OMP_TARGET_GPU
   omp_set_default_device(device);
@@ -39,22 +124,23 @@ OMPStream<T>::~OMPStream()
 {
 #ifdef OMP_TARGET_GPU
   // End data region on device
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   T *a = this->a;
   T *b = this->b;
   T *c = this->c;
   #pragma omp target exit data map(release: a[0:array_size], b[0:array_size], c[0:array_size])
   {}
 #endif
-  free(a);
-  free(b);
-  free(c);
+  free_host(a);
+  free_host(b);
+  free_host(c);
+  free_host(idx);
 }
 
 template <class T>
 void OMPStream<T>::init_arrays(T initA, T initB, T initC)
 {
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
 #ifdef OMP_TARGET_GPU
   T *a = this->a;
   T *b = this->b;
@@ -63,7 +149,7 @@ void OMPStream<T>::init_arrays(T initA, T initB, T initC)
 #else
   #pragma omp parallel for
 #endif
-  for (int i = 0; i < array_size; i++)
+  for (intptr_t i = 0; i < array_size; i++)
   {
     a[i] = initA;
     b[i] = initB;
@@ -89,7 +175,7 @@ void OMPStream<T>::read_arrays(std::vector<T>& h_a, std::vector<T>& h_b, std::ve
 #endif
 
   #pragma omp parallel for
-  for (int i = 0; i < array_size; i++)
+  for (intptr_t i = 0; i < array_size; i++)
   {
     h_a[i] = a[i];
     h_b[i] = b[i];
@@ -98,18 +184,90 @@ void OMPStream<T>::read_arrays(std::vector<T>& h_a, std::vector<T>& h_b, std::ve
 
 }
 
+template <class T>
+bool OMPStream<T>::set_array_size(intptr_t n)
+{
+#ifdef OMP_TARGET_GPU
+  // The device mapping is tied to the full array size
+  return false;
+#else
+  array_size = n;
+  return true;
+#endif
+}
+
+template <class T>
+bool OMPStream<T>::set_num_threads(int n)
+{
+#ifdef OMP_TARGET_GPU
+  // Device parallelism is set by the teams construct, not the host thread count
+  return false;
+#else
+  omp_set_num_threads(n);
+  // New threads start out with the affinity of the thread creating them
+  return binding.empty() || pinOpenMPThreads(binding);
+#endif
+}
+
+template <class T>
+bool OMPStream<T>::set_inner_reps(unsigned int reps)
+{
+#ifdef OMP_TARGET_GPU
+  return reps == 1;
+#else
+  inner_reps = reps;
+  return true;
+#endif
+}
+
+template <class T>
+bool OMPStream<T>::set_affinity(const std::vector<int>& cpus)
+{
+#ifdef OMP_TARGET_GPU
+  return false;
+#else
+  binding = cpus;
+  return pinOpenMPThreads(binding);
+#endif
+}
+
+template <class T>
+bool OMPStream<T>::set_nontemporal(bool enabled)
+{
+#if defined(NT_VECTOR_BYTES) && !defined(OMP_TARGET_GPU)
+  nontemporal = enabled;
+  return true;
+#else
+  // No non-temporal store for this target, or kernels run on the device
+  return !enabled;
+#endif
+}
+
 template <class T>
 void OMPStream<T>::copy()
 {
 #ifdef OMP_TARGET_GPU
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   T *a = this->a;
   T *c = this->c;
   #pragma omp target teams distribute parallel for simd
 #else
-  #pragma omp parallel for
+#ifdef NT_VECTOR_BYTES
+  if (nontemporal)
+  {
+    T *a = this->a;
+    T *c = this->c;
+    stream_kernel(c, array_size, [=](intptr_t i) { return a[i]; });
+    return;
+  }
 #endif
-  for (int i = 0; i < array_size; i++)
+  // Under a static schedule every repetition gives each thread the same elements, so
+  // no barrier is needed between them
+  #pragma omp parallel
+  for (unsigned int rep = 0; rep < inner_reps; rep++)
+  #pragma omp for schedule(static) nowait
+#endif
+  for (intptr_t i = 0; i < array_size; i++)
   {
     c[i] = a[i];
   }
@@ -123,17 +281,28 @@ void OMPStream<T>::copy()
 template <class T>
 void OMPStream<T>::mul()
 {
-  const T scalar = startScalar;
+  const T scalar = Element<T>::scalar();
 
 #ifdef OMP_TARGET_GPU
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   T *b = this->b;
   T *c = this->c;
   #pragma omp target teams distribute parallel for simd
 #else
-  #pragma omp parallel for
+#ifdef NT_VECTOR_BYTES
+  if (nontemporal)
+  {
+    T *b = this->b;
+    T *c = this->c;
+    stream_kernel(b, array_size, [=](intptr_t i) { return scalar * c[i]; });
+    return;
+  }
+#endif
+  #pragma omp parallel
+  for (unsigned int rep = 0; rep < inner_reps; rep++)
+  #pragma omp for schedule(static) nowait
 #endif
-  for (int i = 0; i < array_size; i++)
+  for (intptr_t i = 0; i < array_size; i++)
   {
     b[i] = scalar * c[i];
   }
@@ -148,15 +317,27 @@ template <class T>
 void OMPStream<T>::add()
 {
 #ifdef OMP_TARGET_GPU
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   T *a = this->a;
   T *b = this->b;
   T *c = this->c;
   #pragma omp target teams distribute parallel for simd
 #else
-  #pragma omp parallel for
+#ifdef NT_VECTOR_BYTES
+  if (nontemporal)
+  {
+    T *a = this->a;
+    T *b = this->b;
+    T *c = this->c;
+    stream_kernel(c, array_size, [=](intptr_t i) { return a[i] + b[i]; });
+    return;
+  }
+#endif
+  #pragma omp parallel
+  for (unsigned int rep = 0; rep < inner_reps; rep++)
+  #pragma omp for schedule(static) nowait
 #endif
-  for (int i = 0; i < array_size; i++)
+  for (intptr_t i = 0; i < array_size; i++)
   {
     c[i] = a[i] + b[i];
   }
@@ -170,18 +351,30 @@ void OMPStream<T>::add()
 template <class T>
 void OMPStream<T>::triad()
 {
-  const T scalar = startScalar;
+  const T scalar = Element<T>::scalar();
 
 #ifdef OMP_TARGET_GPU
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   T *a = this->a;
   T *b = this->b;
   T *c = this->c;
   #pragma omp target teams distribute parallel for simd
 #else
-  #pragma omp parallel for
+#ifdef NT_VECTOR_BYTES
+  if (nontemporal)
+  {
+    T *a = this->a;
+    T *b = this->b;
+    T *c = this->c;
+    stream_kernel(a, array_size, [=](intptr_t i) { return b[i] + scalar * c[i]; });
+    return;
+  }
 #endif
-  for (int i = 0; i < array_size; i++)
+  #pragma omp parallel
+  for (unsigned int rep = 0; rep < inner_reps; rep++)
+  #pragma omp for schedule(static) nowait
+#endif
+  for (intptr_t i = 0; i < array_size; i++)
   {
     a[i] = b[i] + scalar * c[i];
   }
@@ -193,12 +386,19 @@ void OMPStream<T>::triad()
 }
 
 template <class T>
-void OMPStream<T>::nstream()
+bool OMPStream<T>::roofline(unsigned int fmas)
 {
-  const T scalar = startScalar;
+  ROOFLINE_DISPATCH(fmas, roofline_kernel)
+}
+
+template <class T>
+template <unsigned int K>
+void OMPStream<T>::roofline_kernel()
+{
+  const T scalar = Element<T>::scalar();
 
 #ifdef OMP_TARGET_GPU
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   T *a = this->a;
   T *b = this->b;
   T *c = this->c;
@@ -206,7 +406,42 @@ void OMPStream<T>::nstream()
 #else
   #pragma omp parallel for
 #endif
-  for (int i = 0; i < array_size; i++)
+  for (intptr_t i = 0; i < array_size; i++)
+  {
+    a[i] = RooflineChain<K>::apply(b[i] + scalar * c[i], c[i], scalar);
+  }
+  #if defined(OMP_TARGET_GPU) && defined(_CRAYC)
+  #pragma omp target update from(a[0:0])
+  #endif
+}
+
+template <class T>
+void OMPStream<T>::nstream()
+{
+  const T scalar = Element<T>::scalar();
+
+#ifdef OMP_TARGET_GPU
+  intptr_t array_size = this->array_size;
+  T *a = this->a;
+  T *b = this->b;
+  T *c = this->c;
+  #pragma omp target teams distribute parallel for simd
+#else
+#ifdef NT_VECTOR_BYTES
+  if (nontemporal)
+  {
+    T *a = this->a;
+    T *b = this->b;
+    T *c = this->c;
+    stream_kernel(a, array_size, [=](intptr_t i) { return a[i] + b[i] + scalar * c[i]; });
+    return;
+  }
+#endif
+  #pragma omp parallel
+  for (unsigned int rep = 0; rep < inner_reps; rep++)
+  #pragma omp for schedule(static) nowait
+#endif
+  for (intptr_t i = 0; i < array_size; i++)
   {
     a[i] += b[i] + scalar * c[i];
   }
@@ -220,25 +455,240 @@ void OMPStream<T>::nstream()
 template <class T>
 T OMPStream<T>::dot()
 {
-  T sum{};
+  typedef typename Element<T>::Sum Sum;
+  Sum sum{};
 
 #ifdef OMP_TARGET_GPU
-  int array_size = this->array_size;
+  intptr_t array_size = this->array_size;
   T *a = this->a;
   T *b = this->b;
   #pragma omp target teams distribute parallel for simd map(tofrom: sum) reduction(+:sum)
 #else
-  #pragma omp parallel for reduction(+:sum)
+  #pragma omp parallel reduction(+:sum)
+  for (unsigned int rep = 0; rep < inner_reps; rep++)
+  #pragma omp for schedule(static) nowait
 #endif
-  for (int i = 0; i < array_size; i++)
+  for (intptr_t i = 0; i < array_size; i++)
   {
-    sum += a[i] * b[i];
+    sum += Sum(a[i]) * Sum(b[i]);
   }
 
+  return T(sum / Sum(inner_reps));
+}
+
+template <class T>
+bool OMPStream<T>::mix(unsigned int reads, unsigned int writes, T& sum)
+{
+#ifdef OMP_TARGET_GPU
+  // The mix arrays are not mapped to the device
+  return false;
+#else
+  if (!mix_supported(reads, writes))
+    return false;
+
+  // Fill new arrays in parallel, so that their pages are first touched by the threads using them
+  for (size_t k = mix_arrays.resize(reads + writes, array_size); k < reads + writes; k++)
+    mix_kernel<0, 1>(mix_arrays.data() + k);
+
+  sum = T(MixDispatch<0, 0>::call(*this, mix_arrays.data(), reads, writes));
+  return true;
+#endif
+}
+
+template <class T>
+template <unsigned int R, unsigned int W>
+typename Element<T>::MixSum OMPStream<T>::mix_kernel(T *const *arrays)
+{
+  typename Element<T>::MixSum sum{};
+  #pragma omp parallel for reduction(+:sum)
+  for (intptr_t i = 0; i < array_size; i++)
+  {
+    sum += MixKernel<R, W>::apply(arrays, i);
+  }
   return sum;
 }
 
+template <class T>
+bool OMPStream<T>::strided_copy(intptr_t stride)
+{
+  const intptr_t n = (array_size + stride - 1) / stride;
 
+#ifdef OMP_TARGET_GPU
+  T *a = this->a;
+  T *c = this->c;
+  #pragma omp target teams distribute parallel for simd
+#else
+  #pragma omp parallel for
+#endif
+  for (intptr_t j = 0; j < n; j++)
+  {
+    c[j * stride] = a[j * stride];
+  }
+  #if defined(OMP_TARGET_GPU) && defined(_CRAYC)
+  #pragma omp target update from(c[0:0])
+  #endif
+  return true;
+}
+
+template <class T>
+bool OMPStream<T>::strided_triad(intptr_t stride)
+{
+  const T scalar = Element<T>::scalar();
+  const intptr_t n = (array_size + stride - 1) / stride;
+
+#ifdef OMP_TARGET_GPU
+  T *a = this->a;
+  T *b = this->b;
+  T *c = this->c;
+  #pragma omp target teams distribute parallel for simd
+#else
+  #pragma omp parallel for
+#endif
+  for (intptr_t j = 0; j < n; j++)
+  {
+    a[j * stride] = b[j * stride] + scalar * c[j * stride];
+  }
+  #if defined(OMP_TARGET_GPU) && defined(_CRAYC)
+  #pragma omp target update from(a[0:0])
+  #endif
+  return true;
+}
+
+template <class T>
+bool OMPStream<T>::set_indices(const std::vector<intptr_t>& indices)
+{
+#ifdef OMP_TARGET_GPU
+  // The index array is not mapped to the device
+  return false;
+#else
+  free_host(idx);
+  idx = alloc_host<intptr_t>(array_size);
+
+  #pragma omp parallel for
+  for (intptr_t i = 0; i < array_size; i++)
+  {
+    idx[i] = indices[i];
+  }
+  return true;
+#endif
+}
+
+template <class T>
+bool OMPStream<T>::gather()
+{
+  if (idx == nullptr)
+    return false;
+
+  #pragma omp parallel for
+  for (intptr_t i = 0; i < array_size; i++)
+  {
+    a[i] = b[idx[i]];
+  }
+  return true;
+}
+
+template <class T>
+bool OMPStream<T>::scatter()
+{
+  if (idx == nullptr)
+    return false;
+
+  #pragma omp parallel for
+  for (intptr_t i = 0; i < array_size; i++)
+  {
+    a[idx[i]] = b[i];
+  }
+  return true;
+}
+
+template <class T>
+bool OMPStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  double sumA = 0.0, sumB = 0.0, sumC = 0.0;
+
+#ifdef OMP_TARGET_GPU
+  intptr_t array_size = this->array_size;
+  T *a = this->a;
+  T *b = this->b;
+  T *c = this->c;
+  #pragma omp target teams distribute parallel for simd map(tofrom: sumA, sumB, sumC) reduction(+:sumA, sumB, sumC)
+#else
+  #pragma omp parallel for reduction(+:sumA, sumB, sumC)
+#endif
+  for (intptr_t i = 0; i < array_size; i++)
+  {
+    sumA += element_abs(a[i] - goldA);
+    sumB += element_abs(b[i] - goldB);
+    sumC += element_abs(c[i] - goldC);
+  }
+
+  errA = sumA / array_size;
+  errB = sumB / array_size;
+  errC = sumC / array_size;
+  return true;
+}
+
+
+template <class T>
+bool OMPStream<T>::validate_strided(intptr_t stride, T stridedA, T stridedB, T stridedC, T goldA, T goldB, T goldC,
+                                    double& errA, double& errB, double& errC)
+{
+  double sumA = 0.0, sumB = 0.0, sumC = 0.0;
+
+#ifdef OMP_TARGET_GPU
+  intptr_t array_size = this->array_size;
+  T *a = this->a;
+  T *b = this->b;
+  T *c = this->c;
+  #pragma omp target teams distribute parallel for simd map(tofrom: sumA, sumB, sumC) reduction(+:sumA, sumB, sumC)
+#else
+  #pragma omp parallel for reduction(+:sumA, sumB, sumC)
+#endif
+  for (intptr_t i = 0; i < array_size; i++)
+  {
+    const bool strided = i % stride == 0;
+    sumA += element_abs(a[i] - (strided ? stridedA : goldA));
+    sumB += element_abs(b[i] - (strided ? stridedB : goldB));
+    sumC += element_abs(c[i] - (strided ? stridedC : goldC));
+  }
+
+  errA = sumA / array_size;
+  errB = sumB / array_size;
+  errC = sumC / array_size;
+  return true;
+}
+
+template <class T>
+bool OMPStream<T>::set_chase(size_t bytes)
+{
+#ifdef OMP_TARGET_GPU
+  return false;
+#else
+  chase_lists.clear();
+  chase_lists.resize(omp_get_max_threads());
+  #pragma omp parallel
+  {
+    const int thread = omp_get_thread_num();
+    chase_lists[thread].reset(new ChaseList());
+    chase_lists[thread]->build(bytes, thread + 1);
+  }
+  return true;
+#endif
+}
+
+template <class T>
+bool OMPStream<T>::chase(unsigned int chains, intptr_t steps)
+{
+  if (chase_lists.empty() || chains < 1 || chains > CHASE_MAX_CHAINS)
+    return false;
+#ifndef OMP_TARGET_GPU
+  uintptr_t end = 0;
+  #pragma omp parallel reduction(^:end)
+  end ^= chase_lists[omp_get_thread_num() % chase_lists.size()]->chase(chains, steps);
+  chase_end = end;
+#endif
+  return true;
+}
 
 void listDevices(void)
 {
@@ -271,3 +721,6 @@ std::string getDeviceDriver(const int)
 }
 template class OMPStream<float>;
 template class OMPStream<double>;
+#ifdef STREAM_EXTRA_TYPES
+STREAM_INSTANTIATE_EXTRA_TYPES(OMPStream)
+#endif
@@ -8,28 +8,57 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 
 #include "Stream.h"
+#include "StreamTypes.h"
+#include "Roofline.h"
+#include "MixKernels.h"
+#include "PointerChase.h"
 
 #include <omp.h>
 
 #define IMPLEMENTATION_STRING "OpenMP"
 
+// Offloaded kernels stay float and double only
+#ifndef OMP_TARGET_GPU
+#define STREAM_EXTRA_TYPES
+#endif
+
 template <class T>
 class OMPStream : public Stream<T>
 {
   protected:
     // Size of arrays
-    int array_size;
+    intptr_t array_size;
 
     // Device side pointers
     T *a;
     T *b;
     T *c;
 
+    // Arrays of the mix kernels, allocated on first use
+    MixArrays<T> mix_arrays;
+
+    // Index array of the gather and scatter kernels, allocated by set_indices
+    intptr_t *idx;
+
+    // Whether the kernels write with non-temporal stores, see set_nontemporal
+    bool nontemporal;
+
+    // Sweeps of the main kernels per call, see set_inner_reps
+    unsigned int inner_reps;
+
+    // CPU of each thread, see set_affinity; empty if unbound
+    std::vector<int> binding;
+
+    // Lists of the latency kernels, one per thread, and where the last chase ended
+    std::vector<std::unique_ptr<ChaseList>> chase_lists;
+    uintptr_t chase_end;
+
   public:
-    OMPStream(const int, int);
+    OMPStream(const intptr_t, int);
     ~OMPStream();
 
     virtual void copy() override;
@@ -41,6 +70,32 @@ class OMPStream : public Stream<T>
 
     virtual void init_arrays(T initA, T initB, T initC) override;
     virtual void read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool set_num_threads(int n) override;
+    virtual bool roofline(unsigned int fmas) override;
+
+    template <unsigned int K>
+    void roofline_kernel();
+
+    virtual bool mix(unsigned int reads, unsigned int writes, T& sum) override;
+
+    template <unsigned int R, unsigned int W>
+    typename Element<T>::MixSum mix_kernel(T *const *arrays);
+
+    virtual bool strided_copy(intptr_t stride) override;
+    virtual bool strided_triad(intptr_t stride) override;
+    virtual bool validate_strided(intptr_t stride, T stridedA, T stridedB, T stridedC, T goldA, T goldB, T goldC,
+                                  double& errA, double& errB, double& errC) override;
+
+    virtual bool set_indices(const std::vector<intptr_t>& indices) override;
+    virtual bool gather() override;
+    virtual bool scatter() override;
+    virtual bool set_nontemporal(bool enabled) override;
+    virtual bool set_inner_reps(unsigned int reps) override;
+    virtual bool set_affinity(const std::vector<int>& cpus) override;
+    virtual bool set_chase(size_t bytes) override;
+    virtual bool chase(unsigned int chains, intptr_t steps) override;
 
 
 
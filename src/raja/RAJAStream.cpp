@@ -10,7 +10,7 @@
 #include "RAJAStream.hpp"
 
 template <class T>
-RAJAStream<T>::RAJAStream(const int ARRAY_SIZE, const int device_index)
+RAJAStream<T>::RAJAStream(const intptr_t ARRAY_SIZE, const int device_index)
     : array_size(ARRAY_SIZE), range(0, ARRAY_SIZE)
 {
     d_a = static_cast<T*>(alloc.allocate(sizeof(T) * array_size));
@@ -54,9 +54,42 @@ void RAJAStream<T>::read_arrays(
   rm.registerAllocation(b.data(), recordB);
   rm.registerAllocation(c.data(), recordC);
   
-  rm.copy(a.data(), d_a);
-  rm.copy(b.data(), d_b);
-  rm.copy(c.data(), d_c);
+  rm.copy(a.data(), d_a, sizeof(T) * array_size);
+  rm.copy(b.data(), d_b, sizeof(T) * array_size);
+  rm.copy(c.data(), d_c, sizeof(T) * array_size);
+}
+
+template <class T>
+bool RAJAStream<T>::set_array_size(intptr_t n)
+{
+  array_size = n;
+  range = RAJA::TypedRangeSegment<RAJA::Index_type>(0, n);
+  return true;
+}
+
+template <class T>
+bool RAJAStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  T* a = d_a;
+  T* b = d_b;
+  T* c = d_c;
+  double sumA = 0.0, sumB = 0.0, sumC = 0.0;
+
+  RAJA::forall<reduce_policy>(range,
+    RAJA::expt::Reduce<RAJA::operators::plus>(&sumA),
+    RAJA::expt::Reduce<RAJA::operators::plus>(&sumB),
+    RAJA::expt::Reduce<RAJA::operators::plus>(&sumC),
+    [=] RAJA_HOST_DEVICE (RAJA::Index_type index, double &_sumA, double &_sumB, double &_sumC) {
+      const T diffA = a[index] - goldA, diffB = b[index] - goldB, diffC = c[index] - goldC;
+      _sumA += diffA < 0 ? -diffA : diffA;
+      _sumB += diffB < 0 ? -diffB : diffB;
+      _sumC += diffC < 0 ? -diffC : diffC;
+  });
+
+  errA = sumA / array_size;
+  errB = sumB / array_size;
+  errC = sumC / array_size;
+  return true;
 }
 
 template <class T>
@@ -107,6 +140,26 @@ void RAJAStream<T>::triad()
   });
 }
 
+template <class T>
+bool RAJAStream<T>::roofline(unsigned int fmas)
+{
+  ROOFLINE_DISPATCH(fmas, roofline_kernel)
+}
+
+template <class T>
+template <unsigned int K>
+void RAJAStream<T>::roofline_kernel()
+{
+  T* a = d_a;
+  T* b = d_b;
+  T* c = d_c;
+  const T scalar = startScalar;
+  RAJA::forall<default_policy>(range, [=] RAJA_HOST_DEVICE (RAJA::Index_type index)
+  {
+    a[index] = RooflineChain<K>::apply(b[index] + scalar*c[index], c[index], scalar);
+  });
+}
+
 template <class T>
 void RAJAStream<T>::nstream()
 {
@@ -15,6 +15,7 @@
 #include "umpire/strategy/AlignedAllocator.hpp"
 
 #include "Stream.h"
+#include "Roofline.h"
 
 #define TBSIZE 1024
 
@@ -46,8 +47,8 @@ template <class T>
 class RAJAStream : public Stream<T> {
   protected:
     // Size of arrays
-  const int array_size;
-  const RAJA::TypedRangeSegment<int> range;
+  intptr_t array_size;
+  RAJA::TypedRangeSegment<RAJA::Index_type> range;
 
     // Umpire Allocators
   umpire::ResourceManager &rm = umpire::ResourceManager::getInstance();
@@ -67,7 +68,7 @@ class RAJAStream : public Stream<T> {
   T* d_c;
 
   public:
-    RAJAStream(const int, const int);
+    RAJAStream(const intptr_t, const int);
     ~RAJAStream();
 
     virtual void copy() override;
@@ -80,4 +81,10 @@ class RAJAStream : public Stream<T> {
     virtual void init_arrays(T initA, T initB, T initC) override;
     virtual void read_arrays(
             std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool roofline(unsigned int fmas) override;
+
+    template <unsigned int K>
+    void roofline_kernel();
 };
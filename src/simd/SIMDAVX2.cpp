@@ -0,0 +1,85 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+// AVX2 and FMA kernels, built with -mavx2 -mfma where the compiler supports them
+
+#include "SIMDKernels.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+template <typename T> struct AVX2Ops;
+
+template <>
+struct AVX2Ops<double>
+{
+  typedef double T;
+  typedef __m256d V;
+  typedef __m256i M;
+
+  static intptr_t lanes() { return 4; }
+  static M mask(intptr_t n) { return _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3)); }
+  static V load(const T *p) { return _mm256_loadu_pd(p); }
+  static V load(const T *p, M m) { return _mm256_maskload_pd(p, m); }
+  static void store(T *p, V v) { _mm256_store_pd(p, v); }
+  static void store(T *p, M m, V v) { _mm256_maskstore_pd(p, m, v); }
+  static V set1(T x) { return _mm256_set1_pd(x); }
+  static V zero() { return _mm256_setzero_pd(); }
+  static V add(V x, V y) { return _mm256_add_pd(x, y); }
+  static V mul(V x, V y) { return _mm256_mul_pd(x, y); }
+  static V fma(V x, V y, V z) { return _mm256_fmadd_pd(x, y, z); }
+  static T sum(V v)
+  {
+    const __m128d pairs = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+  }
+};
+
+template <>
+struct AVX2Ops<float>
+{
+  typedef float T;
+  typedef __m256 V;
+  typedef __m256i M;
+
+  static intptr_t lanes() { return 8; }
+  static M mask(intptr_t n) { return _mm256_cmpgt_epi32(_mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+  static V load(const T *p) { return _mm256_loadu_ps(p); }
+  static V load(const T *p, M m) { return _mm256_maskload_ps(p, m); }
+  static void store(T *p, V v) { _mm256_store_ps(p, v); }
+  static void store(T *p, M m, V v) { _mm256_maskstore_ps(p, m, v); }
+  static V set1(T x) { return _mm256_set1_ps(x); }
+  static V zero() { return _mm256_setzero_ps(); }
+  static V add(V x, V y) { return _mm256_add_ps(x, y); }
+  static V mul(V x, V y) { return _mm256_mul_ps(x, y); }
+  static V fma(V x, V y, V z) { return _mm256_fmadd_ps(x, y, z); }
+  static T sum(V v)
+  {
+    __m128 quad = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+    return _mm_cvtss_f32(_mm_add_ss(quad, _mm_shuffle_ps(quad, quad, 1)));
+  }
+};
+
+template <typename T>
+const SIMDKernelTable<T> *simd_avx2_kernels()
+{
+  static const SIMDKernelTable<T> kernels = SIMDKernels<AVX2Ops<T>>::table("AVX2");
+  return &kernels;
+}
+
+#else
+
+template <typename T>
+const SIMDKernelTable<T> *simd_avx2_kernels()
+{
+  return nullptr;
+}
+
+#endif
+
+template const SIMDKernelTable<float> *simd_avx2_kernels<float>();
+template const SIMDKernelTable<double> *simd_avx2_kernels<double>();
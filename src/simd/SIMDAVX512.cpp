@@ -0,0 +1,93 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+// AVX-512 kernels, built with -mavx512f where the compiler supports it
+
+#include "SIMDKernels.h"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+template <typename T> struct AVX512Ops;
+
+template <>
+struct AVX512Ops<double>
+{
+  typedef double T;
+  typedef __m512d V;
+  typedef __mmask8 M;
+
+  static intptr_t lanes() { return 8; }
+  static M mask(intptr_t n) { return static_cast<M>((1u << n) - 1); }
+  static V load(const T *p) { return _mm512_loadu_pd(p); }
+  static V load(const T *p, M m) { return _mm512_maskz_loadu_pd(m, p); }
+  static void store(T *p, V v) { _mm512_store_pd(p, v); }
+  static void store(T *p, M m, V v) { _mm512_mask_storeu_pd(p, m, v); }
+  static V set1(T x) { return _mm512_set1_pd(x); }
+  static V zero() { return _mm512_setzero_pd(); }
+  static V add(V x, V y) { return _mm512_add_pd(x, y); }
+  static V mul(V x, V y) { return _mm512_mul_pd(x, y); }
+  static V fma(V x, V y, V z) { return _mm512_fmadd_pd(x, y, z); }
+  // By hand rather than with _mm512_reduce_add_pd, and only with _mm512_permutex2var_pd:
+  // GCC 12 implements the 512-bit extracts, casts and other shuffles with an undefined
+  // operand that it then warns is uninitialized. Each step adds lane i ^ 4, 2, then 1.
+  static T sum(V v)
+  {
+    v = _mm512_add_pd(v, _mm512_permutex2var_pd(v, _mm512_set_epi64(3, 2, 1, 0, 7, 6, 5, 4), v));
+    v = _mm512_add_pd(v, _mm512_permutex2var_pd(v, _mm512_set_epi64(5, 4, 7, 6, 1, 0, 3, 2), v));
+    v = _mm512_add_pd(v, _mm512_permutex2var_pd(v, _mm512_set_epi64(6, 7, 4, 5, 2, 3, 0, 1), v));
+    return _mm512_cvtsd_f64(v);
+  }
+};
+
+template <>
+struct AVX512Ops<float>
+{
+  typedef float T;
+  typedef __m512 V;
+  typedef __mmask16 M;
+
+  static intptr_t lanes() { return 16; }
+  static M mask(intptr_t n) { return static_cast<M>((1u << n) - 1); }
+  static V load(const T *p) { return _mm512_loadu_ps(p); }
+  static V load(const T *p, M m) { return _mm512_maskz_loadu_ps(m, p); }
+  static void store(T *p, V v) { _mm512_store_ps(p, v); }
+  static void store(T *p, M m, V v) { _mm512_mask_storeu_ps(p, m, v); }
+  static V set1(T x) { return _mm512_set1_ps(x); }
+  static V zero() { return _mm512_setzero_ps(); }
+  static V add(V x, V y) { return _mm512_add_ps(x, y); }
+  static V mul(V x, V y) { return _mm512_mul_ps(x, y); }
+  static V fma(V x, V y, V z) { return _mm512_fmadd_ps(x, y, z); }
+  // As for double, adding lane i ^ 8, 4, 2, then 1
+  static T sum(V v)
+  {
+    v = _mm512_add_ps(v, _mm512_permutex2var_ps(v, _mm512_set_epi32(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8), v));
+    v = _mm512_add_ps(v, _mm512_permutex2var_ps(v, _mm512_set_epi32(11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4), v));
+    v = _mm512_add_ps(v, _mm512_permutex2var_ps(v, _mm512_set_epi32(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2), v));
+    v = _mm512_add_ps(v, _mm512_permutex2var_ps(v, _mm512_set_epi32(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1), v));
+    return _mm512_cvtss_f32(v);
+  }
+};
+
+template <typename T>
+const SIMDKernelTable<T> *simd_avx512_kernels()
+{
+  static const SIMDKernelTable<T> kernels = SIMDKernels<AVX512Ops<T>>::table("AVX-512");
+  return &kernels;
+}
+
+#else
+
+template <typename T>
+const SIMDKernelTable<T> *simd_avx512_kernels()
+{
+  return nullptr;
+}
+
+#endif
+
+template const SIMDKernelTable<float> *simd_avx512_kernels<float>();
+template const SIMDKernelTable<double> *simd_avx512_kernels<double>();
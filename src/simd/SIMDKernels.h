@@ -0,0 +1,206 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <cstdint>
+
+// Kernels of the SIMD model for one instruction set, each over one thread's share of the
+// arrays. Every instruction set is built in its own translation unit with the compiler
+// flags it needs, and SIMDStream picks one at runtime from what the CPU supports. Code
+// here must not call inline library functions: a copy built with -mavx512f could be the
+// one the linker keeps for every translation unit.
+template <typename T>
+struct SIMDKernelTable
+{
+  const char *isa;
+  void (*copy)(const T *a, T *c, intptr_t n);
+  void (*mul)(const T *c, T *b, T scalar, intptr_t n);
+  void (*add)(const T *a, const T *b, T *c, intptr_t n);
+  void (*triad)(const T *b, const T *c, T *a, T scalar, intptr_t n);
+  void (*nstream)(const T *b, const T *c, T *a, T scalar, intptr_t n);
+  T (*dot)(const T *a, const T *b, intptr_t n);
+};
+
+// Kernels of each instruction set, nullptr where the target or compiler can't build them
+template <typename T> const SIMDKernelTable<T> *simd_avx512_kernels();
+template <typename T> const SIMDKernelTable<T> *simd_avx2_kernels();
+template <typename T> const SIMDKernelTable<T> *simd_sse2_kernels();
+template <typename T> const SIMDKernelTable<T> *simd_sve_kernels();
+template <typename T> const SIMDKernelTable<T> *simd_neon_kernels();
+
+// The kernels written once against the vector operations of an instruction set, Ops:
+//   T, V, M          element, vector and mask types
+//   lanes()          elements per vector
+//   mask(n)          mask of the first n lanes, n <= lanes()
+//   load(p)          unaligned load; store(p, v) aligned store
+//   load(p, m)       masked load, zero in the other lanes; store(p, m, v) masked store
+//   set1(x), zero(), add(x, y), mul(x, y), fma(x, y, z) = x * y + z, sum(v)
+// The output of each kernel is peeled with a masked operation up to vector alignment, so
+// that the main loop uses aligned stores, and the remainder is a masked operation too.
+template <class Ops>
+struct SIMDKernels
+{
+  typedef typename Ops::T T;
+  typedef typename Ops::V V;
+  typedef typename Ops::M M;
+
+  // Elements before p is aligned to a vector, at most n
+  static intptr_t peel(const T *p, intptr_t n)
+  {
+    const uintptr_t bytes = Ops::lanes() * sizeof(T);
+    const uintptr_t misaligned = reinterpret_cast<uintptr_t>(p) % bytes;
+    const intptr_t elements = misaligned == 0 ? 0 : (bytes - misaligned) / sizeof(T);
+    return elements < n ? elements : n;
+  }
+
+  static void copy(const T *a, T *c, intptr_t n)
+  {
+    const intptr_t lanes = Ops::lanes();
+    intptr_t i = peel(c, n);
+    if (i > 0)
+    {
+      const M m = Ops::mask(i);
+      Ops::store(c, m, Ops::load(a, m));
+    }
+    for (; i + lanes <= n; i += lanes)
+      Ops::store(c + i, Ops::load(a + i));
+    if (i < n)
+    {
+      const M m = Ops::mask(n - i);
+      Ops::store(c + i, m, Ops::load(a + i, m));
+    }
+  }
+
+  static void mul(const T *c, T *b, T scalar, intptr_t n)
+  {
+    const intptr_t lanes = Ops::lanes();
+    const V s = Ops::set1(scalar);
+    intptr_t i = peel(b, n);
+    if (i > 0)
+    {
+      const M m = Ops::mask(i);
+      Ops::store(b, m, Ops::mul(s, Ops::load(c, m)));
+    }
+    for (; i + lanes <= n; i += lanes)
+      Ops::store(b + i, Ops::mul(s, Ops::load(c + i)));
+    if (i < n)
+    {
+      const M m = Ops::mask(n - i);
+      Ops::store(b + i, m, Ops::mul(s, Ops::load(c + i, m)));
+    }
+  }
+
+  static void add(const T *a, const T *b, T *c, intptr_t n)
+  {
+    const intptr_t lanes = Ops::lanes();
+    intptr_t i = peel(c, n);
+    if (i > 0)
+    {
+      const M m = Ops::mask(i);
+      Ops::store(c, m, Ops::add(Ops::load(a, m), Ops::load(b, m)));
+    }
+    for (; i + lanes <= n; i += lanes)
+      Ops::store(c + i, Ops::add(Ops::load(a + i), Ops::load(b + i)));
+    if (i < n)
+    {
+      const M m = Ops::mask(n - i);
+      Ops::store(c + i, m, Ops::add(Ops::load(a + i, m), Ops::load(b + i, m)));
+    }
+  }
+
+  static void triad(const T *b, const T *c, T *a, T scalar, intptr_t n)
+  {
+    const intptr_t lanes = Ops::lanes();
+    const V s = Ops::set1(scalar);
+    intptr_t i = peel(a, n);
+    if (i > 0)
+    {
+      const M m = Ops::mask(i);
+      Ops::store(a, m, Ops::fma(s, Ops::load(c, m), Ops::load(b, m)));
+    }
+    for (; i + lanes <= n; i += lanes)
+      Ops::store(a + i, Ops::fma(s, Ops::load(c + i), Ops::load(b + i)));
+    if (i < n)
+    {
+      const M m = Ops::mask(n - i);
+      Ops::store(a + i, m, Ops::fma(s, Ops::load(c + i, m), Ops::load(b + i, m)));
+    }
+  }
+
+  static void nstream(const T *b, const T *c, T *a, T scalar, intptr_t n)
+  {
+    const intptr_t lanes = Ops::lanes();
+    const V s = Ops::set1(scalar);
+    intptr_t i = peel(a, n);
+    if (i > 0)
+    {
+      const M m = Ops::mask(i);
+      Ops::store(a, m, Ops::add(Ops::load(a, m), Ops::fma(s, Ops::load(c, m), Ops::load(b, m))));
+    }
+    for (; i + lanes <= n; i += lanes)
+      Ops::store(a + i, Ops::add(Ops::load(a + i), Ops::fma(s, Ops::load(c + i), Ops::load(b + i))));
+    if (i < n)
+    {
+      const M m = Ops::mask(n - i);
+      Ops::store(a + i, m, Ops::add(Ops::load(a + i, m), Ops::fma(s, Ops::load(c + i, m), Ops::load(b + i, m))));
+    }
+  }
+
+  static T dot(const T *a, const T *b, intptr_t n)
+  {
+    // Two accumulators hide the latency of the dependent multiply-adds
+    const intptr_t lanes = Ops::lanes();
+    V sum0 = Ops::zero(), sum1 = Ops::zero();
+    intptr_t i = 0;
+    for (; i + 2 * lanes <= n; i += 2 * lanes)
+    {
+      sum0 = Ops::fma(Ops::load(a + i), Ops::load(b + i), sum0);
+      sum1 = Ops::fma(Ops::load(a + i + lanes), Ops::load(b + i + lanes), sum1);
+    }
+    for (; i < n; i += lanes)
+    {
+      const M m = Ops::mask(n - i < lanes ? n - i : lanes);
+      sum0 = Ops::fma(Ops::load(a + i, m), Ops::load(b + i, m), sum0);
+    }
+    return Ops::sum(Ops::add(sum0, sum1));
+  }
+
+  static SIMDKernelTable<T> table(const char *isa)
+  {
+    SIMDKernelTable<T> kernels = {isa, copy, mul, add, triad, nstream, dot};
+    return kernels;
+  }
+};
+
+// Masked operations for instruction sets without masked loads and stores, where the mask
+// is a count of lanes moved through a buffer. Ops derives from this and brings load and
+// store into scope next to its own unmasked ones.
+template <typename T, class Ops>
+struct SIMDBufferedMask
+{
+  typedef intptr_t M;
+
+  static M mask(intptr_t n) { return n; }
+
+  template <class O = Ops>
+  static typename O::V load(const T *p, M n)
+  {
+    alignas(64) T buffer[64 / sizeof(T)] = {};
+    for (intptr_t l = 0; l < n; l++)
+      buffer[l] = p[l];
+    return O::load(buffer);
+  }
+
+  template <typename V>
+  static void store(T *p, M n, V v)
+  {
+    alignas(64) T buffer[64 / sizeof(T)];
+    Ops::store(buffer, v);
+    for (intptr_t l = 0; l < n; l++)
+      p[l] = buffer[l];
+  }
+};
@@ -0,0 +1,72 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+// NEON (Advanced SIMD) kernels, the baseline of AArch64
+
+#include "SIMDKernels.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+
+template <typename T> struct NEONOps;
+
+template <>
+struct NEONOps<double> : SIMDBufferedMask<double, NEONOps<double>>
+{
+  typedef double T;
+  typedef float64x2_t V;
+  using SIMDBufferedMask::load;
+  using SIMDBufferedMask::store;
+
+  static intptr_t lanes() { return 2; }
+  static V load(const T *p) { return vld1q_f64(p); }
+  static void store(T *p, V v) { vst1q_f64(p, v); }
+  static V set1(T x) { return vdupq_n_f64(x); }
+  static V zero() { return vdupq_n_f64(0.0); }
+  static V add(V x, V y) { return vaddq_f64(x, y); }
+  static V mul(V x, V y) { return vmulq_f64(x, y); }
+  static V fma(V x, V y, V z) { return vfmaq_f64(z, x, y); }
+  static T sum(V v) { return vaddvq_f64(v); }
+};
+
+template <>
+struct NEONOps<float> : SIMDBufferedMask<float, NEONOps<float>>
+{
+  typedef float T;
+  typedef float32x4_t V;
+  using SIMDBufferedMask::load;
+  using SIMDBufferedMask::store;
+
+  static intptr_t lanes() { return 4; }
+  static V load(const T *p) { return vld1q_f32(p); }
+  static void store(T *p, V v) { vst1q_f32(p, v); }
+  static V set1(T x) { return vdupq_n_f32(x); }
+  static V zero() { return vdupq_n_f32(0.0f); }
+  static V add(V x, V y) { return vaddq_f32(x, y); }
+  static V mul(V x, V y) { return vmulq_f32(x, y); }
+  static V fma(V x, V y, V z) { return vfmaq_f32(z, x, y); }
+  static T sum(V v) { return vaddvq_f32(v); }
+};
+
+template <typename T>
+const SIMDKernelTable<T> *simd_neon_kernels()
+{
+  static const SIMDKernelTable<T> kernels = SIMDKernels<NEONOps<T>>::table("NEON");
+  return &kernels;
+}
+
+#else
+
+template <typename T>
+const SIMDKernelTable<T> *simd_neon_kernels()
+{
+  return nullptr;
+}
+
+#endif
+
+template const SIMDKernelTable<float> *simd_neon_kernels<float>();
+template const SIMDKernelTable<double> *simd_neon_kernels<double>();
@@ -0,0 +1,76 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+// SSE2 kernels, the baseline of x86-64
+
+#include "SIMDKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+template <typename T> struct SSE2Ops;
+
+template <>
+struct SSE2Ops<double> : SIMDBufferedMask<double, SSE2Ops<double>>
+{
+  typedef double T;
+  typedef __m128d V;
+  using SIMDBufferedMask::load;
+  using SIMDBufferedMask::store;
+
+  static intptr_t lanes() { return 2; }
+  static V load(const T *p) { return _mm_loadu_pd(p); }
+  static void store(T *p, V v) { _mm_store_pd(p, v); }
+  static V set1(T x) { return _mm_set1_pd(x); }
+  static V zero() { return _mm_setzero_pd(); }
+  static V add(V x, V y) { return _mm_add_pd(x, y); }
+  static V mul(V x, V y) { return _mm_mul_pd(x, y); }
+  static V fma(V x, V y, V z) { return _mm_add_pd(_mm_mul_pd(x, y), z); }
+  static T sum(V v) { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+};
+
+template <>
+struct SSE2Ops<float> : SIMDBufferedMask<float, SSE2Ops<float>>
+{
+  typedef float T;
+  typedef __m128 V;
+  using SIMDBufferedMask::load;
+  using SIMDBufferedMask::store;
+
+  static intptr_t lanes() { return 4; }
+  static V load(const T *p) { return _mm_loadu_ps(p); }
+  static void store(T *p, V v) { _mm_store_ps(p, v); }
+  static V set1(T x) { return _mm_set1_ps(x); }
+  static V zero() { return _mm_setzero_ps(); }
+  static V add(V x, V y) { return _mm_add_ps(x, y); }
+  static V mul(V x, V y) { return _mm_mul_ps(x, y); }
+  static V fma(V x, V y, V z) { return _mm_add_ps(_mm_mul_ps(x, y), z); }
+  static T sum(V v)
+  {
+    const V pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+  }
+};
+
+template <typename T>
+const SIMDKernelTable<T> *simd_sse2_kernels()
+{
+  static const SIMDKernelTable<T> kernels = SIMDKernels<SSE2Ops<T>>::table("SSE2");
+  return &kernels;
+}
+
+#else
+
+template <typename T>
+const SIMDKernelTable<T> *simd_sse2_kernels()
+{
+  return nullptr;
+}
+
+#endif
+
+template const SIMDKernelTable<float> *simd_sse2_kernels<float>();
+template const SIMDKernelTable<double> *simd_sse2_kernels<double>();
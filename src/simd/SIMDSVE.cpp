@@ -0,0 +1,77 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+// SVE kernels, built with -march=armv8-a+sve where the compiler supports it. The vector
+// length is only known at runtime, and predicates serve as the masks.
+
+#include "SIMDKernels.h"
+
+#if defined(__ARM_FEATURE_SVE)
+#include <arm_sve.h>
+
+template <typename T> struct SVEOps;
+
+template <>
+struct SVEOps<double>
+{
+  typedef double T;
+  typedef svfloat64_t V;
+  typedef svbool_t M;
+
+  static intptr_t lanes() { return svcntd(); }
+  static M mask(intptr_t n) { return svwhilelt_b64(intptr_t{0}, n); }
+  static V load(const T *p) { return svld1_f64(svptrue_b64(), p); }
+  static V load(const T *p, M m) { return svld1_f64(m, p); }
+  static void store(T *p, V v) { svst1_f64(svptrue_b64(), p, v); }
+  static void store(T *p, M m, V v) { svst1_f64(m, p, v); }
+  static V set1(T x) { return svdup_n_f64(x); }
+  static V zero() { return svdup_n_f64(0.0); }
+  static V add(V x, V y) { return svadd_f64_x(svptrue_b64(), x, y); }
+  static V mul(V x, V y) { return svmul_f64_x(svptrue_b64(), x, y); }
+  static V fma(V x, V y, V z) { return svmla_f64_x(svptrue_b64(), z, x, y); }
+  static T sum(V v) { return svaddv_f64(svptrue_b64(), v); }
+};
+
+template <>
+struct SVEOps<float>
+{
+  typedef float T;
+  typedef svfloat32_t V;
+  typedef svbool_t M;
+
+  static intptr_t lanes() { return svcntw(); }
+  static M mask(intptr_t n) { return svwhilelt_b32(intptr_t{0}, n); }
+  static V load(const T *p) { return svld1_f32(svptrue_b32(), p); }
+  static V load(const T *p, M m) { return svld1_f32(m, p); }
+  static void store(T *p, V v) { svst1_f32(svptrue_b32(), p, v); }
+  static void store(T *p, M m, V v) { svst1_f32(m, p, v); }
+  static V set1(T x) { return svdup_n_f32(x); }
+  static V zero() { return svdup_n_f32(0.0f); }
+  static V add(V x, V y) { return svadd_f32_x(svptrue_b32(), x, y); }
+  static V mul(V x, V y) { return svmul_f32_x(svptrue_b32(), x, y); }
+  static V fma(V x, V y, V z) { return svmla_f32_x(svptrue_b32(), z, x, y); }
+  static T sum(V v) { return svaddv_f32(svptrue_b32(), v); }
+};
+
+template <typename T>
+const SIMDKernelTable<T> *simd_sve_kernels()
+{
+  static const SIMDKernelTable<T> kernels = SIMDKernels<SVEOps<T>>::table("SVE");
+  return &kernels;
+}
+
+#else
+
+template <typename T>
+const SIMDKernelTable<T> *simd_sve_kernels()
+{
+  return nullptr;
+}
+
+#endif
+
+template const SIMDKernelTable<float> *simd_sve_kernels<float>();
+template const SIMDKernelTable<double> *simd_sve_kernels<double>();
@@ -0,0 +1,287 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include <cmath>
+#include <string>
+#include "SIMDStream.h"
+#include "Affinity.h"
+#include "PageAllocator.h"
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1 << 22)
+#endif
+#endif
+
+// Threads split the arrays at multiples of a cache line
+#define CHUNK_BYTES 64
+
+// One element at a time, for targets without any of the instruction sets
+template <typename E>
+struct ScalarOps
+{
+  typedef E T;
+  typedef E V;
+  typedef intptr_t M;
+
+  static intptr_t lanes() { return 1; }
+  static M mask(intptr_t n) { return n; }
+  static V load(const T *p) { return *p; }
+  static V load(const T *p, M m) { return m > 0 ? *p : T{}; }
+  static void store(T *p, V v) { *p = v; }
+  static void store(T *p, M m, V v) { if (m > 0) *p = v; }
+  static V set1(T x) { return x; }
+  static V zero() { return T{}; }
+  static V add(V x, V y) { return x + y; }
+  static V mul(V x, V y) { return x * y; }
+  static V fma(V x, V y, V z) { return x * y + z; }
+  static T sum(V v) { return v; }
+};
+
+template <typename T>
+static const SIMDKernelTable<T> *scalar_kernels()
+{
+  static const SIMDKernelTable<T> kernels = SIMDKernels<ScalarOps<T>>::table("Scalar");
+  return &kernels;
+}
+
+// Kernels the CPU can run, best first
+template <typename T>
+static std::vector<const SIMDKernelTable<T> *> available_kernels()
+{
+  std::vector<const SIMDKernelTable<T> *> tables;
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    tables.push_back(simd_avx512_kernels<T>());
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    tables.push_back(simd_avx2_kernels<T>());
+  if (__builtin_cpu_supports("sse2"))
+    tables.push_back(simd_sse2_kernels<T>());
+#elif defined(__aarch64__)
+#ifdef __linux__
+  if (getauxval(AT_HWCAP) & HWCAP_SVE)
+    tables.push_back(simd_sve_kernels<T>());
+#endif
+  tables.push_back(simd_neon_kernels<T>());
+#endif
+  // Drop those the compiler couldn't build
+  std::vector<const SIMDKernelTable<T> *> built;
+  for (const SIMDKernelTable<T> *table : tables)
+    if (table)
+      built.push_back(table);
+  built.push_back(scalar_kernels<T>());
+  return built;
+}
+
+template <class T>
+SIMDStream<T>::SIMDStream(const intptr_t ARRAY_SIZE, int device)
+{
+  const std::vector<const SIMDKernelTable<T> *> tables = available_kernels<T>();
+  if (device < 0 || device >= (int)tables.size())
+    throw std::runtime_error("Invalid device index");
+  kernels = tables[device];
+  std::cout << "Using instruction set: " << kernels->isa << std::endl;
+
+  array_size = ARRAY_SIZE;
+
+  // Allocate on the host
+  this->a = allocArray<T>(array_size);
+  this->b = allocArray<T>(array_size);
+  this->c = allocArray<T>(array_size);
+}
+
+template <class T>
+SIMDStream<T>::~SIMDStream()
+{
+  freePages(a);
+  freePages(b);
+  freePages(c);
+}
+
+template <class T>
+void SIMDStream<T>::chunk(intptr_t& begin, intptr_t& end) const
+{
+  // Split into whole cache lines, so that no two threads write the same line and the
+  // kernels of each thread peel the same way on every call
+  const intptr_t line = CHUNK_BYTES / sizeof(T);
+  const intptr_t lines = (array_size + line - 1) / line;
+  const intptr_t threads = omp_get_num_threads();
+  const intptr_t thread = omp_get_thread_num();
+  begin = std::min(array_size, lines * thread / threads * line);
+  end = std::min(array_size, lines * (thread + 1) / threads * line);
+}
+
+template <class T>
+void SIMDStream<T>::init_arrays(T initA, T initB, T initC)
+{
+  // First touch with the same partitioning as the kernels
+  #pragma omp parallel
+  {
+    intptr_t begin, end;
+    chunk(begin, end);
+    for (intptr_t i = begin; i < end; i++)
+    {
+      a[i] = initA;
+      b[i] = initB;
+      c[i] = initC;
+    }
+  }
+}
+
+template <class T>
+void SIMDStream<T>::read_arrays(std::vector<T>& h_a, std::vector<T>& h_b, std::vector<T>& h_c)
+{
+  #pragma omp parallel
+  {
+    intptr_t begin, end;
+    chunk(begin, end);
+    for (intptr_t i = begin; i < end; i++)
+    {
+      h_a[i] = a[i];
+      h_b[i] = b[i];
+      h_c[i] = c[i];
+    }
+  }
+}
+
+template <class T>
+bool SIMDStream<T>::set_array_size(intptr_t n)
+{
+  array_size = n;
+  return true;
+}
+
+template <class T>
+bool SIMDStream<T>::set_num_threads(int n)
+{
+  omp_set_num_threads(n);
+  return binding.empty() || pinOpenMPThreads(binding);
+}
+
+template <class T>
+bool SIMDStream<T>::set_affinity(const std::vector<int>& cpus)
+{
+  binding = cpus;
+  return pinOpenMPThreads(binding);
+}
+
+template <class T>
+void SIMDStream<T>::copy()
+{
+  #pragma omp parallel
+  {
+    intptr_t begin, end;
+    chunk(begin, end);
+    kernels->copy(a + begin, c + begin, end - begin);
+  }
+}
+
+template <class T>
+void SIMDStream<T>::mul()
+{
+  const T scalar = startScalar;
+  #pragma omp parallel
+  {
+    intptr_t begin, end;
+    chunk(begin, end);
+    kernels->mul(c + begin, b + begin, scalar, end - begin);
+  }
+}
+
+template <class T>
+void SIMDStream<T>::add()
+{
+  #pragma omp parallel
+  {
+    intptr_t begin, end;
+    chunk(begin, end);
+    kernels->add(a + begin, b + begin, c + begin, end - begin);
+  }
+}
+
+template <class T>
+void SIMDStream<T>::triad()
+{
+  const T scalar = startScalar;
+  #pragma omp parallel
+  {
+    intptr_t begin, end;
+    chunk(begin, end);
+    kernels->triad(b + begin, c + begin, a + begin, scalar, end - begin);
+  }
+}
+
+template <class T>
+void SIMDStream<T>::nstream()
+{
+  const T scalar = startScalar;
+  #pragma omp parallel
+  {
+    intptr_t begin, end;
+    chunk(begin, end);
+    kernels->nstream(b + begin, c + begin, a + begin, scalar, end - begin);
+  }
+}
+
+template <class T>
+T SIMDStream<T>::dot()
+{
+  T sum{};
+  #pragma omp parallel reduction(+:sum)
+  {
+    intptr_t begin, end;
+    chunk(begin, end);
+    sum += kernels->dot(a + begin, b + begin, end - begin);
+  }
+  return sum;
+}
+
+template <class T>
+bool SIMDStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  double sumA = 0.0, sumB = 0.0, sumC = 0.0;
+
+  #pragma omp parallel for reduction(+:sumA, sumB, sumC)
+  for (intptr_t i = 0; i < array_size; i++)
+  {
+    sumA += std::fabs(a[i] - goldA);
+    sumB += std::fabs(b[i] - goldB);
+    sumC += std::fabs(c[i] - goldC);
+  }
+
+  errA = sumA / array_size;
+  errB = sumB / array_size;
+  errC = sumC / array_size;
+  return true;
+}
+
+void listDevices(void)
+{
+  // Every instruction set the CPU supports, as double and float build the same ones
+  const std::vector<const SIMDKernelTable<double> *> tables = available_kernels<double>();
+  std::cout << "Devices:" << std::endl;
+  for (size_t i = 0; i < tables.size(); i++)
+    std::cout << i << ": " << tables[i]->isa << std::endl;
+  std::cout << std::endl;
+}
+
+std::string getDeviceName(const int device)
+{
+  const std::vector<const SIMDKernelTable<double> *> tables = available_kernels<double>();
+  if (device < 0 || device >= (int)tables.size())
+    return std::string("Invalid device");
+  return std::string(tables[device]->isa) + " on the host";
+}
+
+std::string getDeviceDriver(const int)
+{
+  return std::string("Device driver unavailable");
+}
+
+template class SIMDStream<float>;
+template class SIMDStream<double>;
@@ -0,0 +1,59 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <iostream>
+#include <stdexcept>
+
+#include "Stream.h"
+#include "SIMDKernels.h"
+
+#include <omp.h>
+
+#define IMPLEMENTATION_STRING "SIMD"
+
+// Hand-vectorised kernels for the host, with the instruction set chosen at runtime from
+// what the CPU supports. Each device is one instruction set, the best first.
+template <class T>
+class SIMDStream : public Stream<T>
+{
+  protected:
+    // Size of arrays
+    intptr_t array_size;
+
+    // Host arrays, aligned so that the threads' chunks start on a cache line
+    T *a;
+    T *b;
+    T *c;
+
+    // Kernels of the chosen instruction set
+    const SIMDKernelTable<T> *kernels;
+
+    // CPU of each thread, see set_affinity; empty if unbound
+    std::vector<int> binding;
+
+    // Range of elements of the calling thread in a parallel region
+    void chunk(intptr_t& begin, intptr_t& end) const;
+
+  public:
+    SIMDStream(const intptr_t, int);
+    ~SIMDStream();
+
+    virtual void copy() override;
+    virtual void add() override;
+    virtual void mul() override;
+    virtual void triad() override;
+    virtual void nstream() override;
+    virtual T dot() override;
+
+    virtual void init_arrays(T initA, T initB, T initC) override;
+    virtual void read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool set_num_threads(int n) override;
+    virtual bool set_affinity(const std::vector<int>& cpus) override;
+};
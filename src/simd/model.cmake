@@ -0,0 +1,32 @@
+
+register_flag_optional(CMAKE_CXX_COMPILER
+        "Any CXX compiler that is supported by CMake detection"
+        "c++")
+
+# Kernels of each instruction set are in their own file, built with the flags that
+# instruction set needs. Files the compiler can't target build without any kernels.
+list(APPEND IMPL_SIMD_SOURCES
+        src/simd/SIMDSSE2.cpp
+        src/simd/SIMDAVX2.cpp
+        src/simd/SIMDAVX512.cpp
+        src/simd/SIMDNEON.cpp
+        src/simd/SIMDSVE.cpp)
+
+macro(setup)
+    find_package(OpenMP REQUIRED)
+    register_link_library(OpenMP::OpenMP_CXX)
+
+    include(CheckCXXCompilerFlag)
+    check_cxx_compiler_flag("-mavx2 -mfma" SIMD_HAS_AVX2)
+    check_cxx_compiler_flag("-mavx512f" SIMD_HAS_AVX512)
+    check_cxx_compiler_flag("-march=armv8-a+sve" SIMD_HAS_SVE)
+    if (SIMD_HAS_AVX2)
+        set_source_files_properties(src/simd/SIMDAVX2.cpp PROPERTIES COMPILE_OPTIONS "-mavx2;-mfma")
+    endif ()
+    if (SIMD_HAS_AVX512)
+        set_source_files_properties(src/simd/SIMDAVX512.cpp PROPERTIES COMPILE_OPTIONS "-mavx512f")
+    endif ()
+    if (SIMD_HAS_SVE)
+        set_source_files_properties(src/simd/SIMDSVE.cpp PROPERTIES COMPILE_OPTIONS "-march=armv8-a+sve")
+    endif ()
+endmacro()
@@ -6,10 +6,12 @@
 
 #include "STDDataStream.h"
 
+#include <cmath>
+
 template <class T>
-STDDataStream<T>::STDDataStream(const int ARRAY_SIZE, int device)
+STDDataStream<T>::STDDataStream(const intptr_t ARRAY_SIZE, int device)
   noexcept : array_size{ARRAY_SIZE},
-  a(alloc_raw<T>(ARRAY_SIZE)), b(alloc_raw<T>(ARRAY_SIZE)), c(alloc_raw<T>(ARRAY_SIZE))
+  a(alloc_raw<T>(ARRAY_SIZE)), b(alloc_raw<T>(ARRAY_SIZE)), c(alloc_raw<T>(ARRAY_SIZE)), inner_reps(1)
 {
     std::cout << "Backing storage typeid: " << typeid(a).name() << std::endl;
 #ifdef USE_ONEDPL
@@ -45,37 +47,87 @@ void STDDataStream<T>::init_arrays(T initA, T initB, T initC)
 template <class T>
 void STDDataStream<T>::read_arrays(std::vector<T>& h_a, std::vector<T>& h_b, std::vector<T>& h_c)
 {
-  std::copy(a, a + array_size, h_a.begin());
-  std::copy(b, b + array_size, h_b.begin());
-  std::copy(c, c + array_size, h_c.begin());
+  copy_to_host(a, array_size, h_a);
+  copy_to_host(b, array_size, h_b);
+  copy_to_host(c, array_size, h_c);
+}
+
+template <class T>
+bool STDDataStream<T>::set_array_size(intptr_t n)
+{
+  array_size = n;
+  return true;
+}
+
+template <class T>
+bool STDDataStream<T>::set_num_threads(int n)
+{
+  return set_policy_threads(n);
+}
+
+template <class T>
+bool STDDataStream<T>::set_affinity(const std::vector<int>& cpus)
+{
+  return set_policy_affinity(cpus);
+}
+
+template <class T>
+bool STDDataStream<T>::set_inner_reps(unsigned int reps)
+{
+  if (reps > 1 && !policy_repeats())
+    return false;
+  inner_reps = reps;
+  return true;
 }
 
 template <class T>
 void STDDataStream<T>::copy()
 {
   // c[i] = a[i]
-  std::copy(exe_policy, a, a + array_size, c);
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::copy(policy, a + begin, a + end, c + begin);
+  });
 }
 
 template <class T>
 void STDDataStream<T>::mul()
 {
   //  b[i] = scalar * c[i];
-  std::transform(exe_policy, c, c + array_size, b, [scalar = startScalar](T ci){ return scalar*ci; });
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::transform(policy, c + begin, c + end, b + begin, [scalar = Element<T>::scalar()](T ci){ return scalar*ci; });
+  });
 }
 
 template <class T>
 void STDDataStream<T>::add()
 {
   //  c[i] = a[i] + b[i];
-  std::transform(exe_policy, a, a + array_size, b, c, std::plus<T>());
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::transform(policy, a + begin, a + end, b + begin, c + begin, std::plus<T>());
+  });
 }
 
 template <class T>
 void STDDataStream<T>::triad()
 {
   //  a[i] = b[i] + scalar * c[i];
-  std::transform(exe_policy, b, b + array_size, c, a, [scalar = startScalar](T bi, T ci){ return bi+scalar*ci; });
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::transform(policy, b + begin, b + end, c + begin, a + begin, [scalar = Element<T>::scalar()](T bi, T ci){ return bi+scalar*ci; });
+  });
+}
+
+template <class T>
+bool STDDataStream<T>::roofline(unsigned int fmas)
+{
+  ROOFLINE_DISPATCH(fmas, roofline_kernel)
+}
+
+template <class T>
+template <unsigned int K>
+void STDDataStream<T>::roofline_kernel()
+{
+  //  a[i] = b[i] + scalar * c[i], then a[i] = a[i] * scalar + c[i] K times
+  std::transform(exe_policy, b, b + array_size, c, a, [scalar = Element<T>::scalar()](T bi, T ci){ return RooflineChain<K>::apply(bi+scalar*ci, ci, scalar); });
 }
 
 template <class T>
@@ -85,8 +137,10 @@ void STDDataStream<T>::nstream()
   //  Need to do in two stages with C++11 STL.
   //  1: a[i] += b[i]
   //  2: a[i] += scalar * c[i];
-  std::transform(exe_policy, a, a + array_size, b, a, [](T ai, T bi){ return ai + bi; });
-  std::transform(exe_policy, a, a + array_size, c, a, [scalar = startScalar](T ai, T ci){ return ai + scalar*ci; });
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::transform(policy, a + begin, a + end, b + begin, a + begin, [](T ai, T bi){ return ai + bi; });
+    std::transform(policy, a + begin, a + end, c + begin, a + begin, [scalar = Element<T>::scalar()](T ai, T ci){ return ai + scalar*ci; });
+  });
 }
    
 
@@ -94,7 +148,25 @@ template <class T>
 T STDDataStream<T>::dot()
 {
   // sum = 0; sum += a[i]*b[i]; return sum;
-  return std::transform_reduce(exe_policy, a, a + array_size, b, T{});
+  typedef typename Element<T>::Sum Sum;
+  return T(sweep_blocks_reduce<Sum>(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    return std::transform_reduce(policy, a + begin, a + end, b + begin, Sum{}, std::plus<Sum>(),
+      [](T ai, T bi) { return Sum(ai) * Sum(bi); });
+  }));
+}
+
+template <class T>
+bool STDDataStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  // err = sum(|x[i] - gold|) / n for each array
+  auto error = [this](const T *x, T gold) {
+    return std::transform_reduce(exe_policy, x, x + array_size, 0.0, std::plus<double>(),
+      [gold](T xi) { return static_cast<double>(element_abs(xi - gold)); }) / array_size;
+  };
+  errA = error(a, goldA);
+  errB = error(b, goldB);
+  errC = error(c, goldC);
+  return true;
 }
 
 void listDevices(void)
@@ -113,3 +185,6 @@ std::string getDeviceDriver(const int)
 }
 template class STDDataStream<float>;
 template class STDDataStream<double>;
+#ifdef STREAM_EXTRA_TYPES
+STREAM_INSTANTIATE_EXTRA_TYPES(STDDataStream)
+#endif
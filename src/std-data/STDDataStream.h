@@ -10,22 +10,32 @@
 #include <iostream>
 #include <stdexcept>
 #include "Stream.h"
+#include "StreamTypes.h"
+#include "Roofline.h"
 
 #define IMPLEMENTATION_STRING "STD (data-oriented)"
 
+// Instantiated for every element type of --type, but on the host only
+#if !(defined(ONEDPL_USE_DPCPP_BACKEND) && ONEDPL_USE_DPCPP_BACKEND)
+#define STREAM_EXTRA_TYPES
+#endif
+
 
 template <class T>
 class STDDataStream : public Stream<T>
 {
   protected:
     // Size of arrays
-    int array_size;
+    intptr_t array_size;
 
     // Device side pointers
     T *a, *b, *c;
 
+    // Sweeps of the main kernels per call, see set_inner_reps
+    unsigned int inner_reps;
+
   public:
-    STDDataStream(const int, int) noexcept;
+    STDDataStream(const intptr_t, int) noexcept;
     ~STDDataStream();
 
     virtual void copy() override;
@@ -37,5 +47,14 @@ class STDDataStream : public Stream<T>
 
     virtual void init_arrays(T initA, T initB, T initC) override;
     virtual void read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool set_num_threads(int n) override;
+    virtual bool set_affinity(const std::vector<int>& cpus) override;
+    virtual bool set_inner_reps(unsigned int reps) override;
+    virtual bool roofline(unsigned int fmas) override;
+
+    template <unsigned int K>
+    void roofline_kernel();
 };
 
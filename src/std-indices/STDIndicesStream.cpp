@@ -6,14 +6,17 @@
 
 #include "STDIndicesStream.h"
 
+#include <cmath>
+
 #ifndef ALIGNMENT
 #define ALIGNMENT (2*1024*1024) // 2MB
 #endif
 
 template <class T>
-STDIndicesStream<T>::STDIndicesStream(const int ARRAY_SIZE, int device)
+STDIndicesStream<T>::STDIndicesStream(const intptr_t ARRAY_SIZE, int device)
 noexcept : array_size{ARRAY_SIZE}, range(0, array_size),
-  a(alloc_raw<T>(ARRAY_SIZE)), b(alloc_raw<T>(ARRAY_SIZE)), c(alloc_raw<T>(ARRAY_SIZE))
+  a(alloc_raw<T>(ARRAY_SIZE)), b(alloc_raw<T>(ARRAY_SIZE)), c(alloc_raw<T>(ARRAY_SIZE)),
+  mix_arrays(alloc_raw<T>, dealloc_raw<T>), idx(nullptr), inner_reps(1)
 {
     std::cout << "Backing storage typeid: " << typeid(a).name() << std::endl;
 #ifdef USE_ONEDPL
@@ -36,6 +39,8 @@ STDIndicesStream<T>::~STDIndicesStream() {
   dealloc_raw(a);
   dealloc_raw(b);
   dealloc_raw(c);
+  if (idx != nullptr)
+    dealloc_raw(idx);
 }
 
 template <class T>
@@ -49,24 +54,58 @@ void STDIndicesStream<T>::init_arrays(T initA, T initB, T initC)
 template <class T>
 void STDIndicesStream<T>::read_arrays(std::vector<T>& h_a, std::vector<T>& h_b, std::vector<T>& h_c)
 {
-  std::copy(a, a + array_size, h_a.begin());
-  std::copy(b, b + array_size, h_b.begin());
-  std::copy(c, c + array_size, h_c.begin());
+  copy_to_host(a, array_size, h_a);
+  copy_to_host(b, array_size, h_b);
+  copy_to_host(c, array_size, h_c);
+}
+
+template <class T>
+bool STDIndicesStream<T>::set_array_size(intptr_t n)
+{
+  array_size = n;
+  range = ranged<intptr_t>(0, n);
+  return true;
+}
+
+template <class T>
+bool STDIndicesStream<T>::set_num_threads(int n)
+{
+  return set_policy_threads(n);
+}
+
+template <class T>
+bool STDIndicesStream<T>::set_affinity(const std::vector<int>& cpus)
+{
+  return set_policy_affinity(cpus);
+}
+
+template <class T>
+bool STDIndicesStream<T>::set_inner_reps(unsigned int reps)
+{
+  if (reps > 1 && !policy_repeats())
+    return false;
+  inner_reps = reps;
+  return true;
 }
 
 template <class T>
 void STDIndicesStream<T>::copy()
 {
   // c[i] = a[i]
-  std::copy(exe_policy, a, a + array_size, c);
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::copy(policy, a + begin, a + end, c + begin);
+  });
 }
 
 template <class T>
 void STDIndicesStream<T>::mul()
 {
   //  b[i] = scalar * c[i];
-  std::transform(exe_policy, range.begin(), range.end(), b, [c = this->c, scalar = startScalar](int i) {
-    return scalar * c[i];
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    ranged<intptr_t> block(begin, end);
+    std::transform(policy, block.begin(), block.end(), b + begin, [c = this->c, scalar = Element<T>::scalar()](intptr_t i) {
+      return scalar * c[i];
+    });
   });
 }
 
@@ -74,8 +113,11 @@ template <class T>
 void STDIndicesStream<T>::add()
 {
   //  c[i] = a[i] + b[i];
-  std::transform(exe_policy, range.begin(), range.end(), c, [a = this->a, b = this->b](int i) {
-    return a[i] + b[i];
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    ranged<intptr_t> block(begin, end);
+    std::transform(policy, block.begin(), block.end(), c + begin, [a = this->a, b = this->b](intptr_t i) {
+      return a[i] + b[i];
+    });
   });
 }
 
@@ -83,8 +125,27 @@ template <class T>
 void STDIndicesStream<T>::triad()
 {
   //  a[i] = b[i] + scalar * c[i];
-  std::transform(exe_policy, range.begin(), range.end(), a, [b = this->b, c = this->c, scalar = startScalar](int i) {
-    return b[i] + scalar * c[i];
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    ranged<intptr_t> block(begin, end);
+    std::transform(policy, block.begin(), block.end(), a + begin, [b = this->b, c = this->c, scalar = Element<T>::scalar()](intptr_t i) {
+      return b[i] + scalar * c[i];
+    });
+  });
+}
+
+template <class T>
+bool STDIndicesStream<T>::roofline(unsigned int fmas)
+{
+  ROOFLINE_DISPATCH(fmas, roofline_kernel)
+}
+
+template <class T>
+template <unsigned int K>
+void STDIndicesStream<T>::roofline_kernel()
+{
+  //  a[i] = b[i] + scalar * c[i], then a[i] = a[i] * scalar + c[i] K times
+  std::transform(exe_policy, range.begin(), range.end(), a, [b = this->b, c = this->c, scalar = Element<T>::scalar()](intptr_t i) {
+    return RooflineChain<K>::apply(b[i] + scalar * c[i], c[i], scalar);
   });
 }
 
@@ -95,8 +156,11 @@ void STDIndicesStream<T>::nstream()
   //  Need to do in two stages with C++11 STL.
   //  1: a[i] += b[i]
   //  2: a[i] += scalar * c[i];
-  std::transform(exe_policy, range.begin(), range.end(), a, [a = this->a, b = this->b, c = this->c, scalar = startScalar](int i) {
-    return a[i] + b[i] + scalar * c[i];
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    ranged<intptr_t> block(begin, end);
+    std::transform(policy, block.begin(), block.end(), a + begin, [a = this->a, b = this->b, c = this->c, scalar = Element<T>::scalar()](intptr_t i) {
+      return a[i] + b[i] + scalar * c[i];
+    });
   });
 }
    
@@ -105,7 +169,123 @@ template <class T>
 T STDIndicesStream<T>::dot()
 {
   // sum = 0; sum += a[i]*b[i]; return sum;
-  return std::transform_reduce(exe_policy, a, a + array_size, b, T{});
+  typedef typename Element<T>::Sum Sum;
+  return T(sweep_blocks_reduce<Sum>(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    return std::transform_reduce(policy, a + begin, a + end, b + begin, Sum{}, std::plus<Sum>(),
+      [](T ai, T bi) { return Sum(ai) * Sum(bi); });
+  }));
+}
+
+template <class T>
+bool STDIndicesStream<T>::mix(unsigned int reads, unsigned int writes, T& sum)
+{
+  if (!mix_supported(reads, writes))
+    return false;
+
+  for (size_t k = mix_arrays.resize(reads + writes, array_size); k < reads + writes; k++)
+    mix_kernel<0, 1>(mix_arrays.data() + k);
+
+  sum = T(MixDispatch<0, 0>::call(*this, mix_arrays.data(), reads, writes));
+  return true;
+}
+
+template <class T>
+template <unsigned int R, unsigned int W>
+typename Element<T>::MixSum STDIndicesStream<T>::mix_kernel(T *const *arrays)
+{
+  //  out[j][i] = (in[0][i] + ... + in[R-1][i]) / R; sum += in[0][i] + ... + in[R-1][i]
+  typedef typename Element<T>::MixSum MixSum;
+  return std::transform_reduce(exe_policy, range.begin(), range.end(), MixSum{}, std::plus<MixSum>(), [arrays](intptr_t i) {
+    return MixKernel<R, W>::apply(arrays, i);
+  });
+}
+
+template <class T>
+bool STDIndicesStream<T>::strided_copy(intptr_t stride)
+{
+  //  c[j * stride] = a[j * stride]
+  ranged<intptr_t> strides(0, (array_size + stride - 1) / stride);
+  std::for_each(exe_policy, strides.begin(), strides.end(), [a = this->a, c = this->c, stride](intptr_t j) {
+    c[j * stride] = a[j * stride];
+  });
+  return true;
+}
+
+template <class T>
+bool STDIndicesStream<T>::strided_triad(intptr_t stride)
+{
+  //  a[j * stride] = b[j * stride] + scalar * c[j * stride]
+  ranged<intptr_t> strides(0, (array_size + stride - 1) / stride);
+  std::for_each(exe_policy, strides.begin(), strides.end(), [a = this->a, b = this->b, c = this->c, scalar = Element<T>::scalar(), stride](intptr_t j) {
+    a[j * stride] = b[j * stride] + scalar * c[j * stride];
+  });
+  return true;
+}
+
+template <class T>
+bool STDIndicesStream<T>::set_indices(const std::vector<intptr_t>& indices)
+{
+  if (idx != nullptr)
+    dealloc_raw(idx);
+  idx = alloc_raw<intptr_t>(array_size);
+  std::copy(exe_policy, indices.begin(), indices.begin() + array_size, idx);
+  return true;
+}
+
+template <class T>
+bool STDIndicesStream<T>::gather()
+{
+  if (idx == nullptr)
+    return false;
+
+  //  a[i] = b[idx[i]]
+  std::transform(exe_policy, range.begin(), range.end(), a, [b = this->b, idx = this->idx](intptr_t i) {
+    return b[idx[i]];
+  });
+  return true;
+}
+
+template <class T>
+bool STDIndicesStream<T>::scatter()
+{
+  if (idx == nullptr)
+    return false;
+
+  //  a[idx[i]] = b[i]
+  std::for_each(exe_policy, range.begin(), range.end(), [a = this->a, b = this->b, idx = this->idx](intptr_t i) {
+    a[idx[i]] = b[i];
+  });
+  return true;
+}
+
+template <class T>
+bool STDIndicesStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  // err = sum(|x[i] - gold|) / n for each array
+  auto error = [this](const T *x, T gold) {
+    return std::transform_reduce(exe_policy, x, x + array_size, 0.0, std::plus<double>(),
+      [gold](T xi) { return static_cast<double>(element_abs(xi - gold)); }) / array_size;
+  };
+  errA = error(a, goldA);
+  errB = error(b, goldB);
+  errC = error(c, goldC);
+  return true;
+}
+
+template <class T>
+bool STDIndicesStream<T>::validate_strided(intptr_t stride, T stridedA, T stridedB, T stridedC, T goldA, T goldB, T goldC,
+                                           double& errA, double& errB, double& errC)
+{
+  // err = sum(|x[i] - (i % stride == 0 ? strided : gold)|) / n for each array
+  auto error = [this, stride](const T *x, T strided, T gold) {
+    ranged<intptr_t> indices(0, array_size);
+    return std::transform_reduce(exe_policy, indices.begin(), indices.end(), 0.0, std::plus<double>(),
+      [x, stride, strided, gold](intptr_t i) { return static_cast<double>(element_abs(x[i] - (i % stride == 0 ? strided : gold))); }) / array_size;
+  };
+  errA = error(a, stridedA, goldA);
+  errB = error(b, stridedB, goldB);
+  errC = error(c, stridedC, goldC);
+  return true;
 }
 
 void listDevices(void)
@@ -124,3 +304,6 @@ std::string getDeviceDriver(const int)
 }
 template class STDIndicesStream<float>;
 template class STDIndicesStream<double>;
+#ifdef STREAM_EXTRA_TYPES
+STREAM_INSTANTIATE_EXTRA_TYPES(STDIndicesStream)
+#endif
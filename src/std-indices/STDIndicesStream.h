@@ -10,9 +10,17 @@
 #include <iostream>
 #include <stdexcept>
 #include "Stream.h"
+#include "StreamTypes.h"
+#include "Roofline.h"
+#include "MixKernels.h"
 
 #define IMPLEMENTATION_STRING "STD (index-oriented)"
 
+// Instantiated for every element type of --type, but on the host only
+#if !(defined(ONEDPL_USE_DPCPP_BACKEND) && ONEDPL_USE_DPCPP_BACKEND)
+#define STREAM_EXTRA_TYPES
+#endif
+
 // A lightweight counting iterator which will be used by the STL algorithms
 // NB: C++ <= 17 doesn't have this built-in, and it's only added later in ranges-v3 (C++2a) which this
 // implementation doesn't target
@@ -71,16 +79,25 @@ class STDIndicesStream : public Stream<T>
 {
   protected:
     // Size of arrays
-    int array_size;
+    intptr_t array_size;
 
     // induction range
-    ranged<int> range;
+    ranged<intptr_t> range;
 
     // Device side pointers
     T *a, *b, *c;
 
+    // Arrays of the mix kernels, allocated on first use
+    MixArrays<T> mix_arrays;
+
+    // Index array of the gather and scatter kernels, allocated by set_indices
+    intptr_t *idx;
+
+    // Sweeps of the main kernels per call, see set_inner_reps
+    unsigned int inner_reps;
+
   public:
-    STDIndicesStream(const int, int) noexcept;
+    STDIndicesStream(const intptr_t, int) noexcept;
     ~STDIndicesStream();
 
     virtual void copy() override;
@@ -92,5 +109,28 @@ class STDIndicesStream : public Stream<T>
 
     virtual void init_arrays(T initA, T initB, T initC) override;
     virtual void read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool set_num_threads(int n) override;
+    virtual bool set_affinity(const std::vector<int>& cpus) override;
+    virtual bool set_inner_reps(unsigned int reps) override;
+    virtual bool roofline(unsigned int fmas) override;
+
+    template <unsigned int K>
+    void roofline_kernel();
+
+    virtual bool mix(unsigned int reads, unsigned int writes, T& sum) override;
+
+    template <unsigned int R, unsigned int W>
+    typename Element<T>::MixSum mix_kernel(T *const *arrays);
+
+    virtual bool strided_copy(intptr_t stride) override;
+    virtual bool strided_triad(intptr_t stride) override;
+    virtual bool validate_strided(intptr_t stride, T stridedA, T stridedB, T stridedC, T goldA, T goldB, T goldC,
+                                  double& errA, double& errB, double& errC) override;
+
+    virtual bool set_indices(const std::vector<intptr_t>& indices) override;
+    virtual bool gather() override;
+    virtual bool scatter() override;
 };
 
@@ -5,6 +5,7 @@
 // source code
 
 #include "STDRangesStream.hpp"
+#include <cmath>
 #include <ranges>
 
 #ifndef ALIGNMENT
@@ -12,9 +13,10 @@
 #endif
 
 template <class T>
-STDRangesStream<T>::STDRangesStream(const int ARRAY_SIZE, int device)
+STDRangesStream<T>::STDRangesStream(const intptr_t ARRAY_SIZE, int device)
 noexcept : array_size{ARRAY_SIZE},
-  a(alloc_raw<T>(ARRAY_SIZE)), b(alloc_raw<T>(ARRAY_SIZE)), c(alloc_raw<T>(ARRAY_SIZE))
+  a(alloc_raw<T>(ARRAY_SIZE)), b(alloc_raw<T>(ARRAY_SIZE)), c(alloc_raw<T>(ARRAY_SIZE)),
+  mix_arrays(alloc_raw<T>, dealloc_raw<T>), idx(nullptr), inner_reps(1)
 {
     std::cout << "Backing storage typeid: " << typeid(a).name() << std::endl;
 #ifdef USE_ONEDPL
@@ -37,6 +39,8 @@ STDRangesStream<T>::~STDRangesStream() {
   dealloc_raw(a);
   dealloc_raw(b);
   dealloc_raw(c);
+  if (idx != nullptr)
+    dealloc_raw(idx);
 }
 
 template <class T>
@@ -44,8 +48,8 @@ void STDRangesStream<T>::init_arrays(T initA, T initB, T initC)
 {
   std::for_each_n(
     exe_policy,
-    std::views::iota(0).begin(), array_size, // loop range
-    [&] (int i) {
+    std::views::iota(intptr_t{0}).begin(), array_size, // loop range
+    [&] (intptr_t i) {
       a[i] = initA;
       b[i] = initB;
       c[i] = initC;
@@ -56,86 +60,290 @@ void STDRangesStream<T>::init_arrays(T initA, T initB, T initC)
 template <class T>
 void STDRangesStream<T>::read_arrays(std::vector<T>& h_a, std::vector<T>& h_b, std::vector<T>& h_c)
 {
-  // Element-wise copy.
-    std::copy(a, a + array_size, h_a.begin());
-    std::copy(b, b + array_size, h_b.begin());
-    std::copy(c, c + array_size, h_c.begin());
+  copy_to_host(a, array_size, h_a);
+  copy_to_host(b, array_size, h_b);
+  copy_to_host(c, array_size, h_c);
+}
+
+template <class T>
+bool STDRangesStream<T>::set_array_size(intptr_t n)
+{
+  array_size = n;
+  return true;
+}
+
+template <class T>
+bool STDRangesStream<T>::set_num_threads(int n)
+{
+  return set_policy_threads(n);
+}
+
+template <class T>
+bool STDRangesStream<T>::set_affinity(const std::vector<int>& cpus)
+{
+  return set_policy_affinity(cpus);
+}
+
+template <class T>
+bool STDRangesStream<T>::set_inner_reps(unsigned int reps)
+{
+  if (reps > 1 && !policy_repeats())
+    return false;
+  inner_reps = reps;
+  return true;
 }
 
 template <class T>
 void STDRangesStream<T>::copy()
 {
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::for_each_n(
+      policy,
+      std::views::iota(begin).begin(), end - begin,
+      [&] (intptr_t i) {
+        c[i] = a[i];
+      }
+    );
+  });
+}
+
+template <class T>
+void STDRangesStream<T>::mul()
+{
+  const T scalar = Element<T>::scalar();
+
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::for_each_n(
+      policy,
+      std::views::iota(begin).begin(), end - begin,
+      [&] (intptr_t i) {
+        b[i] = scalar * c[i];
+      }
+    );
+  });
+}
+
+template <class T>
+void STDRangesStream<T>::add()
+{
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::for_each_n(
+      policy,
+      std::views::iota(begin).begin(), end - begin,
+      [&] (intptr_t i) {
+        c[i] = a[i] + b[i];
+      }
+    );
+  });
+}
+
+template <class T>
+void STDRangesStream<T>::triad()
+{
+  const T scalar = Element<T>::scalar();
+
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::for_each_n(
+      policy,
+      std::views::iota(begin).begin(), end - begin,
+      [&] (intptr_t i) {
+        a[i] = b[i] + scalar * c[i];
+      }
+    );
+  });
+}
+
+template <class T>
+bool STDRangesStream<T>::roofline(unsigned int fmas)
+{
+  ROOFLINE_DISPATCH(fmas, roofline_kernel)
+}
+
+template <class T>
+template <unsigned int K>
+void STDRangesStream<T>::roofline_kernel()
+{
+  const T scalar = Element<T>::scalar();
+
   std::for_each_n(
     exe_policy,
-    std::views::iota(0).begin(), array_size,
-    [&] (int i) {
-      c[i] = a[i];
+    std::views::iota(intptr_t{0}).begin(), array_size,
+    [&] (intptr_t i) {
+      a[i] = RooflineChain<K>::apply(b[i] + scalar * c[i], c[i], scalar);
     }
   );
 }
 
 template <class T>
-void STDRangesStream<T>::mul()
+void STDRangesStream<T>::nstream()
+{
+  const T scalar = Element<T>::scalar();
+
+  sweep_blocks(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+    std::for_each_n(
+      policy,
+      std::views::iota(begin).begin(), end - begin,
+      [&] (intptr_t i) {
+        a[i] += b[i] + scalar * c[i];
+      }
+    );
+  });
+}
+
+template <class T>
+T STDRangesStream<T>::dot()
+{
+  // sum += a[i] * b[i];
+  typedef typename Element<T>::Sum Sum;
+  return T(
+    sweep_blocks_reduce<Sum>(array_size, inner_reps, [&](auto policy, intptr_t begin, intptr_t end) {
+      return std::transform_reduce(
+        policy,
+        a + begin, a + end, b + begin, Sum{}, std::plus<Sum>(),
+        [](T ai, T bi) { return Sum(ai) * Sum(bi); });
+    }));
+}
+
+template <class T>
+bool STDRangesStream<T>::mix(unsigned int reads, unsigned int writes, T& sum)
 {
-  const T scalar = startScalar;
+  if (!mix_supported(reads, writes))
+    return false;
+
+  for (size_t k = mix_arrays.resize(reads + writes, array_size); k < reads + writes; k++)
+    mix_kernel<0, 1>(mix_arrays.data() + k);
 
+  sum = T(MixDispatch<0, 0>::call(*this, mix_arrays.data(), reads, writes));
+  return true;
+}
+
+template <class T>
+template <unsigned int R, unsigned int W>
+typename Element<T>::MixSum STDRangesStream<T>::mix_kernel(T *const *arrays)
+{
+  typedef typename Element<T>::MixSum MixSum;
+  auto indices = std::views::iota(intptr_t{0}, array_size);
+  return
+    std::transform_reduce(
+      exe_policy,
+      indices.begin(), indices.end(), MixSum{}, std::plus<MixSum>(),
+      [arrays] (intptr_t i) {
+        return MixKernel<R, W>::apply(arrays, i);
+      }
+    );
+}
+
+template <class T>
+bool STDRangesStream<T>::strided_copy(intptr_t stride)
+{
   std::for_each_n(
     exe_policy,
-    std::views::iota(0).begin(), array_size,
-    [&] (int i) {
-      b[i] = scalar * c[i];
+    std::views::iota(intptr_t{0}).begin(), (array_size + stride - 1) / stride,
+    [&] (intptr_t j) {
+      c[j * stride] = a[j * stride];
     }
   );
+  return true;
 }
 
 template <class T>
-void STDRangesStream<T>::add()
+bool STDRangesStream<T>::strided_triad(intptr_t stride)
 {
+  const T scalar = Element<T>::scalar();
+
   std::for_each_n(
     exe_policy,
-    std::views::iota(0).begin(), array_size,
-    [&] (int i) {
-      c[i] = a[i] + b[i];
+    std::views::iota(intptr_t{0}).begin(), (array_size + stride - 1) / stride,
+    [&] (intptr_t j) {
+      a[j * stride] = b[j * stride] + scalar * c[j * stride];
     }
   );
+  return true;
 }
 
 template <class T>
-void STDRangesStream<T>::triad()
+bool STDRangesStream<T>::set_indices(const std::vector<intptr_t>& indices)
 {
-  const T scalar = startScalar;
+  if (idx != nullptr)
+    dealloc_raw(idx);
+  idx = alloc_raw<intptr_t>(array_size);
 
   std::for_each_n(
     exe_policy,
-    std::views::iota(0).begin(), array_size,
-    [&] (int i) {
-      a[i] = b[i] + scalar * c[i];
+    std::views::iota(intptr_t{0}).begin(), array_size,
+    [&] (intptr_t i) {
+      idx[i] = indices[i];
     }
   );
+  return true;
 }
 
 template <class T>
-void STDRangesStream<T>::nstream()
+bool STDRangesStream<T>::gather()
 {
-  const T scalar = startScalar;
+  if (idx == nullptr)
+    return false;
 
   std::for_each_n(
     exe_policy,
-    std::views::iota(0).begin(), array_size,
-    [&] (int i) {
-      a[i] += b[i] + scalar * c[i];
+    std::views::iota(intptr_t{0}).begin(), array_size,
+    [&] (intptr_t i) {
+      a[i] = b[idx[i]];
     }
   );
+  return true;
 }
 
 template <class T>
-T STDRangesStream<T>::dot()
+bool STDRangesStream<T>::scatter()
 {
-  // sum += a[i] * b[i];
-  return
-    std::transform_reduce(
-      exe_policy,
-      a, a + array_size, b, T{});
+  if (idx == nullptr)
+    return false;
+
+  std::for_each_n(
+    exe_policy,
+    std::views::iota(intptr_t{0}).begin(), array_size,
+    [&] (intptr_t i) {
+      a[idx[i]] = b[i];
+    }
+  );
+  return true;
+}
+
+template <class T>
+bool STDRangesStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  // err = sum(|x[i] - gold|) / n for each array
+  auto error = [&](const T *x, T gold) {
+    return
+      std::transform_reduce(
+        exe_policy,
+        x, x + array_size, 0.0, std::plus<double>(),
+        [gold] (T xi) { return static_cast<double>(element_abs(xi - gold)); }) / array_size;
+  };
+  errA = error(a, goldA);
+  errB = error(b, goldB);
+  errC = error(c, goldC);
+  return true;
+}
+
+template <class T>
+bool STDRangesStream<T>::validate_strided(intptr_t stride, T stridedA, T stridedB, T stridedC, T goldA, T goldB, T goldC,
+                                          double& errA, double& errB, double& errC)
+{
+  // err = sum(|x[i] - (i % stride == 0 ? strided : gold)|) / n for each array
+  auto error = [&](const T *x, T strided, T gold) {
+    auto indices = std::views::iota(intptr_t{0}, array_size);
+    return
+      std::transform_reduce(
+        exe_policy,
+        indices.begin(), indices.end(), 0.0, std::plus<double>(),
+        [&] (intptr_t i) { return static_cast<double>(element_abs(x[i] - (i % stride == 0 ? strided : gold))); }) / array_size;
+  };
+  errA = error(a, stridedA, goldA);
+  errB = error(b, stridedB, goldB);
+  errC = error(c, stridedC, goldC);
+  return true;
 }
 
 void listDevices(void)
@@ -155,3 +363,6 @@ std::string getDeviceDriver(const int)
 
 template class STDRangesStream<float>;
 template class STDRangesStream<double>;
+#ifdef STREAM_EXTRA_TYPES
+STREAM_INSTANTIATE_EXTRA_TYPES(STDRangesStream)
+#endif
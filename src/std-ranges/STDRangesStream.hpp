@@ -10,21 +10,38 @@
 #include <iostream>
 #include <stdexcept>
 #include "Stream.h"
+#include "StreamTypes.h"
+#include "Roofline.h"
+#include "MixKernels.h"
 
 #define IMPLEMENTATION_STRING "STD C++ ranges"
 
+// Instantiated for every element type of --type, but on the host only
+#if !(defined(ONEDPL_USE_DPCPP_BACKEND) && ONEDPL_USE_DPCPP_BACKEND)
+#define STREAM_EXTRA_TYPES
+#endif
+
 template <class T>
 class STDRangesStream : public Stream<T>
 {
   protected:
     // Size of arrays
-    int array_size;
+    intptr_t array_size;
 
     // Device side pointers
     T *a, *b, *c;
 
+    // Arrays of the mix kernels, allocated on first use
+    MixArrays<T> mix_arrays;
+
+    // Index array of the gather and scatter kernels, allocated by set_indices
+    intptr_t *idx;
+
+    // Sweeps of the main kernels per call, see set_inner_reps
+    unsigned int inner_reps;
+
   public:
-    STDRangesStream(const int, int) noexcept;
+    STDRangesStream(const intptr_t, int) noexcept;
     ~STDRangesStream();
 
     virtual void copy() override;
@@ -36,6 +53,29 @@ class STDRangesStream : public Stream<T>
 
     virtual void init_arrays(T initA, T initB, T initC) override;
     virtual void read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool set_num_threads(int n) override;
+    virtual bool set_affinity(const std::vector<int>& cpus) override;
+    virtual bool set_inner_reps(unsigned int reps) override;
+    virtual bool roofline(unsigned int fmas) override;
+
+    template <unsigned int K>
+    void roofline_kernel();
+
+    virtual bool mix(unsigned int reads, unsigned int writes, T& sum) override;
+
+    template <unsigned int R, unsigned int W>
+    typename Element<T>::MixSum mix_kernel(T *const *arrays);
+
+    virtual bool strided_copy(intptr_t stride) override;
+    virtual bool strided_triad(intptr_t stride) override;
+    virtual bool validate_strided(intptr_t stride, T stridedA, T stridedB, T stridedC, T goldA, T goldB, T goldC,
+                                  double& errA, double& errB, double& errC) override;
+
+    virtual bool set_indices(const std::vector<intptr_t>& indices) override;
+    virtual bool gather() override;
+    virtual bool scatter() override;
 
 };
 
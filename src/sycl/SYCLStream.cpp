@@ -17,7 +17,7 @@ std::vector<device> devices;
 void getDeviceList(void);
 
 template <class T>
-SYCLStream<T>::SYCLStream(const int ARRAY_SIZE, const int device_index)
+SYCLStream<T>::SYCLStream(const intptr_t ARRAY_SIZE, const int device_index)
 {
   if (!cached)
     getDeviceList();
@@ -243,7 +243,7 @@ void SYCLStream<T>::read_arrays(std::vector<T>& a, std::vector<T>& b, std::vecto
   auto _a = d_a->template get_access<access::mode::read>();
   auto _b = d_b->template get_access<access::mode::read>();
   auto _c = d_c->template get_access<access::mode::read>();
-  for (int i = 0; i < array_size; i++)
+  for (size_t i = 0; i < array_size; i++)
   {
     a[i] = _a[i];
     b[i] = _b[i];
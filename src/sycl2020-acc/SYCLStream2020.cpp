@@ -211,7 +211,7 @@ void SYCLStream<T>::read_arrays(std::vector<T>& a, std::vector<T>& b, std::vecto
   sycl::host_accessor _a {d_a, sycl::read_only};
   sycl::host_accessor _b {d_b, sycl::read_only};
   sycl::host_accessor _c {d_c, sycl::read_only};
-  for (int i = 0; i < array_size; i++)
+  for (size_t i = 0; i < array_size; i++)
   {
     a[i] = _a[i];
     b[i] = _b[i];
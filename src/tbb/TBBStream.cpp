@@ -5,31 +5,35 @@
 // source code
 
 #include "TBBStream.hpp"
+#include <array>
+#include <cmath>
 #include <cstdlib>
+#include "PageAllocator.h"
 
-#ifndef ALIGNMENT
-#define ALIGNMENT (2*1024*1024) // 2MB
-#endif
+template <class T>
+static T *alloc_host(size_t n)
+{
+  return allocArray<T>(n);
+}
 
-#ifdef USE_VECTOR
-#define BEGIN(x) (x).begin()
-#define END(x) (x).end()
-#else
-#define BEGIN(x) (x)
-#define END(x) ((x) + array_size)
-#endif
+template <class T>
+static void free_host(T *p)
+{
+  freePages(p);
+}
 
 template <class T>
-TBBStream<T>::TBBStream(const int ARRAY_SIZE, int device)
+TBBStream<T>::TBBStream(const intptr_t ARRAY_SIZE, int device)
  : partitioner(), range(0, ARRAY_SIZE),
 #ifdef USE_VECTOR
-   a(ARRAY_SIZE), b(ARRAY_SIZE), c(ARRAY_SIZE)
+   a(ARRAY_SIZE), b(ARRAY_SIZE), c(ARRAY_SIZE),
 #else
    array_size(ARRAY_SIZE),
-   a((T *) aligned_alloc(ALIGNMENT, sizeof(T) * ARRAY_SIZE)),
-   b((T *) aligned_alloc(ALIGNMENT, sizeof(T) * ARRAY_SIZE)),
-   c((T *) aligned_alloc(ALIGNMENT, sizeof(T) * ARRAY_SIZE))
+   a(alloc_host<T>(ARRAY_SIZE)),
+   b(alloc_host<T>(ARRAY_SIZE)),
+   c(alloc_host<T>(ARRAY_SIZE)),
 #endif
+   mix_arrays(alloc_host<T>, free_host<T>), idx(nullptr), inner_reps(1)
 {
   if(device != 0){
     throw std::runtime_error("Device != 0 is not supported by TBB");
@@ -39,6 +43,17 @@ TBBStream<T>::TBBStream(const int ARRAY_SIZE, int device)
 }
 
 
+template <class T>
+TBBStream<T>::~TBBStream()
+{
+#ifndef USE_VECTOR
+  free_host(a);
+  free_host(b);
+  free_host(c);
+#endif
+  free_host(idx);
+}
+
 template <class T>
 void TBBStream<T>::init_arrays(T initA, T initB, T initC)
 {
@@ -56,32 +71,120 @@ void TBBStream<T>::init_arrays(T initA, T initB, T initC)
 template <class T>
 void TBBStream<T>::read_arrays(std::vector<T>& h_a, std::vector<T>& h_b, std::vector<T>& h_c)
 {
-  // Element-wise copy.
-  std::copy(BEGIN(a), END(a), h_a.begin());
-  std::copy(BEGIN(b), END(b), h_b.begin());
-  std::copy(BEGIN(c), END(c), h_c.begin());
+  // In parallel, each thread reading back the elements its kernels wrote
+  tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
+    for (size_t i = r.begin(); i < r.end(); ++i) {
+      h_a[i] = a[i];
+      h_b[i] = b[i];
+      h_c[i] = c[i];
+    }
+  }, partitioner);
+}
+
+template <class T>
+bool TBBStream<T>::set_array_size(intptr_t n)
+{
+  range = tbb::blocked_range<size_t>(0, n);
+#ifndef USE_VECTOR
+  array_size = n;
+#endif
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::set_num_threads(int n)
+{
+  // Only one control may be alive, TBB would otherwise keep the most restrictive limit
+  control.reset();
+  control.reset(new tbb::global_control(tbb::global_control::max_allowed_parallelism, n));
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::set_affinity(const std::vector<int>& cpus)
+{
+  pinning.reset();
+  pinning.reset(new TBBPinObserver(cpus));
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::set_inner_reps(unsigned int reps)
+{
+  inner_reps = reps;
+  return true;
+}
+
+// Run body(begin, end) over the arrays: once over the range with the chosen partitioner
+// or, with inner repetition, inner_reps times over each of one block per thread. TBB has
+// no parallel region to stay in, so each block repeats on its own.
+template <class T>
+template <class F>
+void TBBStream<T>::sweep(const F& body)
+{
+  if (inner_reps == 1)
+  {
+    tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
+      body(r.begin(), r.end());
+    }, partitioner);
+    return;
+  }
+
+  const size_t blocks = tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks, 1), [&](const tbb::blocked_range<size_t>& r) {
+    for (size_t block = r.begin(); block < r.end(); ++block) {
+      const size_t begin = range.size() * block / blocks, end = range.size() * (block + 1) / blocks;
+      for (unsigned int rep = 0; rep < inner_reps; rep++)
+        body(begin, end);
+    }
+  }, block_partitioner);
+}
+
+// As sweep, summing what body returns over one sweep
+template <class T>
+template <class F>
+typename Element<T>::Sum TBBStream<T>::sweep_reduce(const F& body)
+{
+  typedef typename Element<T>::Sum Sum;
+  if (inner_reps == 1)
+  {
+    return tbb::parallel_reduce(range, Sum{}, [&](const tbb::blocked_range<size_t>& r, Sum acc) {
+      return acc + body(r.begin(), r.end());
+    }, std::plus<Sum>(), partitioner);
+  }
+
+  const size_t blocks = tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism);
+  const Sum sum = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, blocks, 1), Sum{}, [&](const tbb::blocked_range<size_t>& r, Sum acc) {
+    for (size_t block = r.begin(); block < r.end(); ++block) {
+      const size_t begin = range.size() * block / blocks, end = range.size() * (block + 1) / blocks;
+      for (unsigned int rep = 0; rep < inner_reps; rep++)
+        acc += body(begin, end);
+    }
+    return acc;
+  }, std::plus<Sum>(), block_partitioner);
+  return sum / Sum(inner_reps);
 }
 
 template <class T>
 void TBBStream<T>::copy()
 {
-  tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
-    for (size_t i = r.begin(); i < r.end(); ++i) {
+  sweep([&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
        c[i] = a[i];
     }
-  }, partitioner);
+  });
 }
 
 template <class T>
 void TBBStream<T>::mul()
 {
-  const T scalar = startScalar;
+  const T scalar = Element<T>::scalar();
 
-  tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
-    for (size_t i = r.begin(); i < r.end(); ++i) {
+  sweep([&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
        b[i] = scalar * c[i];
     }
-  }, partitioner);
+  });
 
 }
 
@@ -89,22 +192,42 @@ template <class T>
 void TBBStream<T>::add()
 {
 
-  tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
-    for (size_t i = r.begin(); i < r.end(); ++i) {
+  sweep([&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
        c[i] = a[i] + b[i];
     }
-  }, partitioner);
+  });
 
 }
 
 template <class T>
 void TBBStream<T>::triad()
 {
-  const T scalar = startScalar;
+  const T scalar = Element<T>::scalar();
+
+  sweep([&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+       a[i] = b[i] + scalar * c[i];
+    }
+  });
+
+}
+
+template <class T>
+bool TBBStream<T>::roofline(unsigned int fmas)
+{
+  ROOFLINE_DISPATCH(fmas, roofline_kernel)
+}
+
+template <class T>
+template <unsigned int K>
+void TBBStream<T>::roofline_kernel()
+{
+  const T scalar = Element<T>::scalar();
 
   tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
     for (size_t i = r.begin(); i < r.end(); ++i) {
-       a[i] = b[i] + scalar * c[i];
+      a[i] = RooflineChain<K>::apply(b[i] + scalar * c[i], c[i], scalar);
     }
   }, partitioner);
 
@@ -113,13 +236,13 @@ void TBBStream<T>::triad()
 template <class T>
 void TBBStream<T>::nstream()
 {
-  const T scalar = startScalar;
+  const T scalar = Element<T>::scalar();
 
-  tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
-    for (size_t i = r.begin(); i < r.end(); ++i) {
+  sweep([&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
        a[i] += b[i] + scalar * c[i];
     }
-  }, partitioner);
+  });
 
 }
 
@@ -127,13 +250,160 @@ template <class T>
 T TBBStream<T>::dot()
 {
   // sum += a[i] * b[i];
+  typedef typename Element<T>::Sum Sum;
   return
-    tbb::parallel_reduce(range, T{}, [&](const tbb::blocked_range<size_t>& r, T acc) {
+    T(sweep_reduce([&](size_t begin, size_t end) {
+      Sum acc{};
+      for (size_t i = begin; i < end; ++i) {
+        acc += Sum(a[i]) * Sum(b[i]);
+      }
+      return acc;
+    }));
+}
+
+template <class T>
+bool TBBStream<T>::mix(unsigned int reads, unsigned int writes, T& sum)
+{
+  if (!mix_supported(reads, writes))
+    return false;
+
+  // Fill new arrays in parallel, so that their pages are first touched by the threads using them
+  for (size_t k = mix_arrays.resize(reads + writes, range.end()); k < reads + writes; k++)
+    mix_kernel<0, 1>(mix_arrays.data() + k);
+
+  sum = T(MixDispatch<0, 0>::call(*this, mix_arrays.data(), reads, writes));
+  return true;
+}
+
+template <class T>
+template <unsigned int R, unsigned int W>
+typename Element<T>::MixSum TBBStream<T>::mix_kernel(T *const *arrays)
+{
+  typedef typename Element<T>::MixSum MixSum;
+  return
+    tbb::parallel_reduce(range, MixSum{}, [&](const tbb::blocked_range<size_t>& r, MixSum acc) {
       for (size_t i = r.begin(); i < r.end(); ++i) {
-        acc += a[i] * b[i];
+        acc += MixKernel<R, W>::apply(arrays, i);
       }
       return acc;
-    }, std::plus<T>(), partitioner);
+    }, std::plus<MixSum>(), partitioner);
+}
+
+template <class T>
+bool TBBStream<T>::strided_copy(intptr_t stride)
+{
+  const size_t n = (range.end() + stride - 1) / stride;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n), [&](const tbb::blocked_range<size_t>& r) {
+    for (size_t j = r.begin(); j < r.end(); ++j) {
+       c[j * stride] = a[j * stride];
+    }
+  }, partitioner);
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::strided_triad(intptr_t stride)
+{
+  const T scalar = Element<T>::scalar();
+  const size_t n = (range.end() + stride - 1) / stride;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n), [&](const tbb::blocked_range<size_t>& r) {
+    for (size_t j = r.begin(); j < r.end(); ++j) {
+       a[j * stride] = b[j * stride] + scalar * c[j * stride];
+    }
+  }, partitioner);
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::set_indices(const std::vector<intptr_t>& indices)
+{
+  free_host(idx);
+  idx = alloc_host<intptr_t>(range.end());
+
+  tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
+    for (size_t i = r.begin(); i < r.end(); ++i) {
+       idx[i] = indices[i];
+    }
+  }, partitioner);
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::gather()
+{
+  if (idx == nullptr)
+    return false;
+
+  tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
+    for (size_t i = r.begin(); i < r.end(); ++i) {
+       a[i] = b[idx[i]];
+    }
+  }, partitioner);
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::scatter()
+{
+  if (idx == nullptr)
+    return false;
+
+  tbb::parallel_for(range, [&](const tbb::blocked_range<size_t>& r) {
+    for (size_t i = r.begin(); i < r.end(); ++i) {
+       a[idx[i]] = b[i];
+    }
+  }, partitioner);
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  typedef std::array<double, 3> errors;
+  errors sum =
+    tbb::parallel_reduce(range, errors{}, [&](const tbb::blocked_range<size_t>& r, errors acc) {
+      for (size_t i = r.begin(); i < r.end(); ++i) {
+        acc[0] += element_abs(a[i] - goldA);
+        acc[1] += element_abs(b[i] - goldB);
+        acc[2] += element_abs(c[i] - goldC);
+      }
+      return acc;
+    }, [](errors x, const errors& y) {
+      for (size_t j = 0; j < x.size(); ++j) x[j] += y[j];
+      return x;
+    }, partitioner);
+
+  errA = sum[0] / range.size();
+  errB = sum[1] / range.size();
+  errC = sum[2] / range.size();
+  return true;
+}
+
+template <class T>
+bool TBBStream<T>::validate_strided(intptr_t stride, T stridedA, T stridedB, T stridedC, T goldA, T goldB, T goldC,
+                                    double& errA, double& errB, double& errC)
+{
+  typedef std::array<double, 3> errors;
+  errors sum =
+    tbb::parallel_reduce(range, errors{}, [&](const tbb::blocked_range<size_t>& r, errors acc) {
+      for (size_t i = r.begin(); i < r.end(); ++i) {
+        const bool strided = i % stride == 0;
+        acc[0] += element_abs(a[i] - (strided ? stridedA : goldA));
+        acc[1] += element_abs(b[i] - (strided ? stridedB : goldB));
+        acc[2] += element_abs(c[i] - (strided ? stridedC : goldC));
+      }
+      return acc;
+    }, [](errors x, const errors& y) {
+      for (size_t j = 0; j < x.size(); ++j) x[j] += y[j];
+      return x;
+    }, partitioner);
+
+  errA = sum[0] / range.size();
+  errB = sum[1] / range.size();
+  errC = sum[2] / range.size();
+  return true;
 }
 
 void listDevices(void)
@@ -153,6 +423,6 @@ std::string getDeviceDriver(const int)
 
 template class TBBStream<float>;
 template class TBBStream<double>;
-
-#undef BEGIN
-#undef END
+#ifdef STREAM_EXTRA_TYPES
+STREAM_INSTANTIATE_EXTRA_TYPES(TBBStream)
+#endif
@@ -7,12 +7,21 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 #include <vector>
 #include "tbb/tbb.h"
 #include "Stream.h"
+#include "StreamTypes.h"
+#include "Roofline.h"
+#include "MixKernels.h"
+#include "PageAllocator.h"
+#include "TBBAffinity.h"
 
 #define IMPLEMENTATION_STRING "TBB"
 
+// Instantiated for every element type of --type
+#define STREAM_EXTRA_TYPES
+
 #if defined(PARTITIONER_AUTO)
 using tbb_partitioner = tbb::auto_partitioner;
 #define PARTITIONER_NAME  "auto_partitioner"
@@ -39,19 +48,39 @@ class TBBStream : public Stream<T>
   
     tbb_partitioner partitioner;
     tbb::blocked_range<size_t> range;
+    // Limits the threads of the default arena, see set_num_threads
+    std::unique_ptr<tbb::global_control> control;
+    // Pins the threads of the default arena, see set_affinity
+    std::unique_ptr<TBBPinObserver> pinning;
     // Device side pointers
 #ifdef USE_VECTOR
-    std::vector<T> a, b, c;
+    // Not zero-filled on construction, so init_arrays places the pages
+    std::vector<T, PageVectorAllocator<T>> a, b, c;
 #else
     size_t array_size;
     T *a, *b, *c;
 #endif
+    // Arrays of the mix kernels, allocated on first use
+    MixArrays<T> mix_arrays;
+
+    // Index array of the gather and scatter kernels, allocated by set_indices
+    intptr_t *idx;
+
+    // Sweeps of the main kernels per call, see set_inner_reps, and the partitioner
+    // that keeps each block of a repeated sweep on the same thread from call to call
+    unsigned int inner_reps;
+    tbb::affinity_partitioner block_partitioner;
+
+    template <class F>
+    void sweep(const F& body);
+    template <class F>
+    typename Element<T>::Sum sweep_reduce(const F& body);
 
 
 
   public:
-    TBBStream(const int, int);
-    ~TBBStream() = default;
+    TBBStream(const intptr_t, int);
+    ~TBBStream();
 
     virtual void copy() override;
     virtual void add() override;
@@ -62,6 +91,29 @@ class TBBStream : public Stream<T>
 
     virtual void init_arrays(T initA, T initB, T initC) override;
     virtual void read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool set_num_threads(int n) override;
+    virtual bool set_affinity(const std::vector<int>& cpus) override;
+    virtual bool set_inner_reps(unsigned int reps) override;
+    virtual bool roofline(unsigned int fmas) override;
+
+    template <unsigned int K>
+    void roofline_kernel();
+
+    virtual bool mix(unsigned int reads, unsigned int writes, T& sum) override;
+
+    template <unsigned int R, unsigned int W>
+    typename Element<T>::MixSum mix_kernel(T *const *arrays);
+
+    virtual bool strided_copy(intptr_t stride) override;
+    virtual bool strided_triad(intptr_t stride) override;
+    virtual bool validate_strided(intptr_t stride, T stridedA, T stridedB, T stridedC, T goldA, T goldB, T goldC,
+                                  double& errA, double& errB, double& errC) override;
+
+    virtual bool set_indices(const std::vector<intptr_t>& indices) override;
+    virtual bool gather() override;
+    virtual bool scatter() override;
 
 };
 
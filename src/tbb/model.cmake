@@ -16,7 +16,7 @@ register_flag_optional(PARTITIONER
         "AUTO")
 
 register_flag_optional(USE_VECTOR
-        "Whether to use std::vector<T> for storage or use aligned_alloc. C++ vectors are *zero* initialised where as aligned_alloc is uninitialised before first use."
+        "Whether to use std::vector<T> for storage or use aligned_alloc. Either way the arrays are uninitialised until init_arrays first touches them in parallel."
         "OFF")
 
 register_flag_optional(USE_TBB
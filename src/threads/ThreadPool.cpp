@@ -0,0 +1,128 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include "ThreadPool.h"
+#include "Affinity.h"
+
+#include <climits>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+static inline void cpu_relax() { _mm_pause(); }
+#elif defined(__aarch64__)
+static inline void cpu_relax() { asm volatile("yield" ::: "memory"); }
+#else
+static inline void cpu_relax() {}
+#endif
+
+// Spins before a waiting thread goes to sleep, a few microseconds of pauses
+#define SPIN_LIMIT (1 << 14)
+
+static void sleepWhile(std::atomic<int>& word, int value)
+{
+#ifdef __linux__
+  // std::atomic<int> is a plain int on Linux, and the kernel rechecks the value
+  syscall(SYS_futex, reinterpret_cast<int *>(&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+  std::this_thread::yield();
+#endif
+}
+
+static void wakeAll(std::atomic<int>& word)
+{
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<int *>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+SpinBarrier::SpinBarrier(int parties) : parties(parties), arrived(0), sense(0), sleepers(0) {}
+
+void SpinBarrier::wait()
+{
+  const int current = sense.load(std::memory_order_acquire);
+  if (arrived.fetch_add(1, std::memory_order_acq_rel) == parties - 1)
+  {
+    // Last to arrive: reset for the next use, then release the others
+    arrived.store(0, std::memory_order_relaxed);
+    sense.fetch_add(1);
+    if (sleepers.load() > 0)
+      wakeAll(sense);
+    return;
+  }
+
+  for (int spin = 0; spin < SPIN_LIMIT; spin++)
+  {
+    if (sense.load(std::memory_order_acquire) != current)
+      return;
+    cpu_relax();
+  }
+
+  // Both this and the release above are sequentially consistent, so either the last
+  // thread sees this sleeper and wakes it, or this thread sees the new sense
+  sleepers.fetch_add(1);
+  while (sense.load() == current)
+    sleepWhile(sense, current);
+  sleepers.fetch_sub(1);
+}
+
+ThreadPool::ThreadPool(int size, const std::vector<int>& cpus)
+  : workers(size), start(size), finish(size), job(nullptr), context(nullptr), stopping(false),
+    cpus(cpus.empty() ? allowedCpus() : cpus)
+{
+#ifdef __linux__
+  cpu_set_t set;
+  pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+  caller_affinity.resize(sizeof(set));
+  std::memcpy(caller_affinity.data(), &set, sizeof(set));
+#endif
+
+  pinThread(cpu(0));
+  for (int worker = 1; worker < workers; worker++)
+    threads.emplace_back(&ThreadPool::work, this, worker);
+}
+
+ThreadPool::~ThreadPool()
+{
+  stopping = true;
+  start.wait();
+  for (std::thread& thread : threads)
+    thread.join();
+
+#ifdef __linux__
+  cpu_set_t set;
+  std::memcpy(&set, caller_affinity.data(), sizeof(set));
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+void ThreadPool::dispatch()
+{
+  start.wait();
+  job(context, 0);
+  finish.wait();
+}
+
+void ThreadPool::work(int worker)
+{
+  // Workers beyond the number of CPUs share them round-robin
+  pinThread(cpu(worker));
+  while (true)
+  {
+    start.wait();
+    if (stopping)
+      return;
+    job(context, worker);
+    finish.wait();
+  }
+}
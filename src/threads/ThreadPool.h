@@ -0,0 +1,82 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Size of the cache line that shared counters and per-thread slots are padded to
+#define POOL_LINE_BYTES 64
+
+// Sense-reversing barrier. Threads spin on the sense, a generation count flipped by the
+// last thread to arrive; after a while they sleep on it with a futex instead, so that a
+// pool with more threads than CPUs still makes progress.
+class SpinBarrier
+{
+  public:
+    explicit SpinBarrier(int parties);
+    void wait();
+
+  private:
+    const int parties;
+    alignas(POOL_LINE_BYTES) std::atomic<int> arrived;
+    alignas(POOL_LINE_BYTES) std::atomic<int> sense;
+    alignas(POOL_LINE_BYTES) std::atomic<int> sleepers;
+};
+
+// A fixed pool of threads created once, worker i pinned to cpus[i % cpus.size()], by
+// default the CPUs the process may run on. The calling thread is worker 0 and the pool
+// adds workers 1..size-1. run(f) calls f(worker) on every worker and returns once all
+// have finished.
+class ThreadPool
+{
+  public:
+    ThreadPool(int size, const std::vector<int>& cpus);
+    ~ThreadPool();
+
+    int size() const { return workers; }
+
+    // CPU a worker is pinned to
+    int cpu(int worker) const { return cpus[worker % cpus.size()]; }
+
+    template <class F>
+    void run(const F& f)
+    {
+      job = &call<F>;
+      context = &f;
+      dispatch();
+    }
+
+  private:
+    template <class F>
+    static void call(const void *f, int worker) { (*static_cast<const F *>(f))(worker); }
+
+    void dispatch();
+    void work(int worker);
+
+    const int workers;
+    std::vector<std::thread> threads;
+    SpinBarrier start, finish;
+
+    // Current job, written by worker 0 before the start barrier
+    void (*job)(const void *, int);
+    const void *context;
+    bool stopping;
+
+    // CPUs to pin to, and the caller's affinity to restore when the pool goes
+    std::vector<int> cpus;
+    std::vector<unsigned char> caller_affinity;
+};
+
+// Value of one worker padded to its own cache line, for reductions
+template <typename T>
+struct alignas(POOL_LINE_BYTES) PaddedSlot
+{
+  T value;
+};
@@ -0,0 +1,352 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#include <cmath>
+#include <cstdlib>  // For getenv
+#include <string>
+#include "ThreadsStream.h"
+#include "Affinity.h"
+#include "PageAllocator.h"
+#include "Topology.h"
+
+// Workers in the pool: OMP_NUM_THREADS if set, as the other CPU models honour it, or
+// one per CPU the process may run on
+static int defaultThreads()
+{
+  const char *env = std::getenv("OMP_NUM_THREADS");
+  const int threads = env ? std::atoi(env) : 0;
+  return threads > 0 ? threads : (int)allowedCpus().size();
+}
+
+template <class T>
+ThreadsStream<T>::ThreadsStream(const intptr_t ARRAY_SIZE, int device)
+  : replicated(false), chase_end(0)
+{
+  if (device != 0)
+    throw std::runtime_error("Invalid device index");
+
+  array_size = ARRAY_SIZE;
+
+  // Allocate on the host
+  this->a = allocArray<T>(array_size);
+  this->b = allocArray<T>(array_size);
+  this->c = allocArray<T>(array_size);
+
+  set_num_threads(defaultThreads());
+  std::cout << "Threads: " << pool->size() << std::endl;
+}
+
+template <class T>
+ThreadsStream<T>::~ThreadsStream()
+{
+  pool.reset();
+  free_chunks();
+  freePages(a);
+  freePages(b);
+  freePages(c);
+}
+
+template <class T>
+void ThreadsStream<T>::free_chunks()
+{
+  if (replicated)
+    for (Chunk& chunk : chunks)
+    {
+      freePages(chunk.a);
+      freePages(chunk.b);
+      freePages(chunk.c);
+    }
+  chunks.clear();
+}
+
+template <class T>
+void ThreadsStream<T>::partition()
+{
+  free_chunks();
+
+  // Whole cache lines, so that no two workers write the same line
+  const intptr_t line = POOL_LINE_BYTES / sizeof(T);
+  const intptr_t lines = (array_size + line - 1) / line;
+  const intptr_t workers = pool->size();
+  for (intptr_t worker = 0; worker < workers; worker++)
+  {
+    Chunk chunk;
+    chunk.begin = std::min(array_size, lines * worker / workers * line);
+    chunk.end = std::min(array_size, lines * (worker + 1) / workers * line);
+    if (replicated)
+    {
+      const int node = std::max(0, cpuNumaNode(pool->cpu(worker)));
+      const size_t bytes = sizeof(T) * (chunk.end - chunk.begin);
+      chunk.a = static_cast<T *>(allocPagesOnNode(bytes, node));
+      chunk.b = static_cast<T *>(allocPagesOnNode(bytes, node));
+      chunk.c = static_cast<T *>(allocPagesOnNode(bytes, node));
+    }
+    else
+    {
+      chunk.a = a + chunk.begin;
+      chunk.b = b + chunk.begin;
+      chunk.c = c + chunk.begin;
+    }
+    chunks.push_back(chunk);
+  }
+}
+
+template <class T>
+bool ThreadsStream<T>::set_num_threads(int n)
+{
+  // Join the old workers before starting the new ones, so that none share a CPU
+  pool.reset();
+  pool.reset(new ThreadPool(n, binding));
+  partial.assign(n, PaddedSlot<typename Element<T>::Sum>{});
+  partition();
+  return true;
+}
+
+template <class T>
+bool ThreadsStream<T>::set_affinity(const std::vector<int>& cpus)
+{
+  binding = cpus;
+  return set_num_threads(pool->size());
+}
+
+template <class T>
+bool ThreadsStream<T>::set_array_size(intptr_t n)
+{
+  // Replicated chunks are sized for the arrays they were allocated with
+  if (replicated)
+    return false;
+  array_size = n;
+  partition();
+  return true;
+}
+
+template <class T>
+bool ThreadsStream<T>::set_replicated(bool enabled)
+{
+  if (enabled == replicated)
+    return true;
+
+  // Only one of the shared arrays and the replicated chunks exists at a time
+  free_chunks();
+  if (enabled)
+  {
+    freePages(a);
+    freePages(b);
+    freePages(c);
+    a = b = c = nullptr;
+  }
+  else
+  {
+    a = allocArray<T>(array_size);
+    b = allocArray<T>(array_size);
+    c = allocArray<T>(array_size);
+  }
+  replicated = enabled;
+  partition();
+  return true;
+}
+
+template <class T>
+void ThreadsStream<T>::init_arrays(T initA, T initB, T initC)
+{
+  // First touch by the worker that owns each chunk
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    T *a = chunk.a, *b = chunk.b, *c = chunk.c;
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+    {
+      a[i] = initA;
+      b[i] = initB;
+      c[i] = initC;
+    }
+  });
+}
+
+template <class T>
+void ThreadsStream<T>::read_arrays(std::vector<T>& h_a, std::vector<T>& h_b, std::vector<T>& h_c)
+{
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+    {
+      h_a[chunk.begin + i] = chunk.a[i];
+      h_b[chunk.begin + i] = chunk.b[i];
+      h_c[chunk.begin + i] = chunk.c[i];
+    }
+  });
+}
+
+template <class T>
+void ThreadsStream<T>::copy()
+{
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    const T *a = chunk.a;
+    T *c = chunk.c;
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+      c[i] = a[i];
+  });
+}
+
+template <class T>
+void ThreadsStream<T>::mul()
+{
+  const T scalar = Element<T>::scalar();
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    T *b = chunk.b;
+    const T *c = chunk.c;
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+      b[i] = scalar * c[i];
+  });
+}
+
+template <class T>
+void ThreadsStream<T>::add()
+{
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    const T *a = chunk.a, *b = chunk.b;
+    T *c = chunk.c;
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+      c[i] = a[i] + b[i];
+  });
+}
+
+template <class T>
+void ThreadsStream<T>::triad()
+{
+  const T scalar = Element<T>::scalar();
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    T *a = chunk.a;
+    const T *b = chunk.b, *c = chunk.c;
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+      a[i] = b[i] + scalar * c[i];
+  });
+}
+
+template <class T>
+void ThreadsStream<T>::nstream()
+{
+  const T scalar = Element<T>::scalar();
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    T *a = chunk.a;
+    const T *b = chunk.b, *c = chunk.c;
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+      a[i] += b[i] + scalar * c[i];
+  });
+}
+
+template <class T>
+T ThreadsStream<T>::dot()
+{
+  typedef typename Element<T>::Sum Sum;
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    const T *a = chunk.a, *b = chunk.b;
+    Sum sum{};
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+      sum += Sum(a[i]) * Sum(b[i]);
+    partial[worker].value = sum;
+  });
+
+  Sum sum{};
+  for (const PaddedSlot<Sum>& slot : partial)
+    sum += slot.value;
+  return T(sum);
+}
+
+template <class T>
+bool ThreadsStream<T>::validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC)
+{
+  std::vector<PaddedSlot<double>> sums(3 * pool->size(), PaddedSlot<double>{});
+  pool->run([&](int worker)
+  {
+    const Chunk& chunk = chunks[worker];
+    double sumA = 0.0, sumB = 0.0, sumC = 0.0;
+    for (intptr_t i = 0; i < chunk.end - chunk.begin; i++)
+    {
+      sumA += element_abs(chunk.a[i] - goldA);
+      sumB += element_abs(chunk.b[i] - goldB);
+      sumC += element_abs(chunk.c[i] - goldC);
+    }
+    sums[3 * worker].value = sumA;
+    sums[3 * worker + 1].value = sumB;
+    sums[3 * worker + 2].value = sumC;
+  });
+
+  double sumA = 0.0, sumB = 0.0, sumC = 0.0;
+  for (int worker = 0; worker < pool->size(); worker++)
+  {
+    sumA += sums[3 * worker].value;
+    sumB += sums[3 * worker + 1].value;
+    sumC += sums[3 * worker + 2].value;
+  }
+  errA = sumA / array_size;
+  errB = sumB / array_size;
+  errC = sumC / array_size;
+  return true;
+}
+
+template <class T>
+bool ThreadsStream<T>::set_chase(size_t bytes)
+{
+  chase_lists.clear();
+  chase_lists.resize(pool->size());
+  pool->run([&](int worker)
+  {
+    chase_lists[worker].reset(new ChaseList());
+    chase_lists[worker]->build(bytes, worker + 1);
+  });
+  return true;
+}
+
+template <class T>
+bool ThreadsStream<T>::chase(unsigned int chains, intptr_t steps)
+{
+  if (chase_lists.empty() || chains < 1 || chains > CHASE_MAX_CHAINS)
+    return false;
+  std::vector<PaddedSlot<uintptr_t>> ends(pool->size(), PaddedSlot<uintptr_t>{});
+  pool->run([&](int worker)
+  {
+    ends[worker].value = chase_lists[worker % chase_lists.size()]->chase(chains, steps);
+  });
+  chase_end = 0;
+  for (const PaddedSlot<uintptr_t>& end : ends)
+    chase_end ^= end.value;
+  return true;
+}
+
+void listDevices(void)
+{
+  std::cout << "0: CPU" << std::endl;
+}
+
+std::string getDeviceName(const int)
+{
+  return std::string("Device name unavailable");
+}
+
+std::string getDeviceDriver(const int)
+{
+  return std::string("Device driver unavailable");
+}
+
+template class ThreadsStream<float>;
+template class ThreadsStream<double>;
+#ifdef STREAM_EXTRA_TYPES
+STREAM_INSTANTIATE_EXTRA_TYPES(ThreadsStream)
+#endif
@@ -0,0 +1,83 @@
+// Copyright (c) 2015-16 Tom Deakin, Simon McIntosh-Smith,
+// University of Bristol HPC
+//
+// For full license terms please see the LICENSE file distributed with this
+// source code
+
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#include "Stream.h"
+#include "StreamTypes.h"
+#include "ThreadPool.h"
+#include "PointerChase.h"
+
+#define IMPLEMENTATION_STRING "C++ threads"
+
+// Instantiated for every element type of --type
+#define STREAM_EXTRA_TYPES
+
+// Kernels run by a persistent pool of pinned std::threads, without any parallel runtime.
+// Each worker owns a fixed, cache-line aligned chunk of every array.
+template <class T>
+class ThreadsStream : public Stream<T>
+{
+  protected:
+    // Size of arrays
+    intptr_t array_size;
+
+    // Host arrays, nullptr while replicated
+    T *a;
+    T *b;
+    T *c;
+
+    std::unique_ptr<ThreadPool> pool;
+
+    // CPU of each worker, empty to use those the process may run on
+    std::vector<int> binding;
+
+    // Elements [begin, end) of a worker, and where they are: in the shared arrays, or in
+    // arrays of its own on its NUMA node when replicated
+    struct Chunk
+    {
+      intptr_t begin, end;
+      T *a, *b, *c;
+    };
+    std::vector<Chunk> chunks;
+    bool replicated;
+
+    // Partial dot products, one cache line per worker
+    std::vector<PaddedSlot<typename Element<T>::Sum>> partial;
+
+    // Lists of the latency kernels, one per worker, and where the last chase ended
+    std::vector<std::unique_ptr<ChaseList>> chase_lists;
+    uintptr_t chase_end;
+
+    // Split the arrays between the workers of the pool, allocating replicated chunks
+    void partition();
+    void free_chunks();
+
+  public:
+    ThreadsStream(const intptr_t, int);
+    ~ThreadsStream();
+
+    virtual void copy() override;
+    virtual void add() override;
+    virtual void mul() override;
+    virtual void triad() override;
+    virtual void nstream() override;
+    virtual T dot() override;
+
+    virtual void init_arrays(T initA, T initB, T initC) override;
+    virtual void read_arrays(std::vector<T>& a, std::vector<T>& b, std::vector<T>& c) override;
+    virtual bool set_array_size(intptr_t n) override;
+    virtual bool validate(T goldA, T goldB, T goldC, double& errA, double& errB, double& errC) override;
+    virtual bool set_num_threads(int n) override;
+    virtual bool set_replicated(bool enabled) override;
+    virtual bool set_affinity(const std::vector<int>& cpus) override;
+    virtual bool set_chase(size_t bytes) override;
+    virtual bool chase(unsigned int chains, intptr_t steps) override;
+};
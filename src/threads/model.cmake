@@ -0,0 +1,14 @@
+
+register_flag_optional(CMAKE_CXX_COMPILER
+        "Any CXX compiler that is supported by CMake detection"
+        "c++")
+
+list(APPEND IMPL_THREADS_SOURCES src/threads/ThreadPool.cpp)
+
+macro(setup)
+    # aligned new for the padded per-thread slots
+    set(CMAKE_CXX_STANDARD 17)
+    set(THREADS_PREFER_PTHREAD_FLAG ON)
+    find_package(Threads REQUIRED)
+    register_link_library(Threads::Threads)
+endmacro()